@@ -0,0 +1,59 @@
+//--------------------------------------------------------------------------------
+// adaptive_quality.h
+//--------------------------------------------------------------------------------
+// Chooses how much work the flag can do each frame
+//--------------------------------------------------------------------------------
+
+#ifndef ADAPTIVE_QUALITY_H
+#define ADAPTIVE_QUALITY_H
+
+#include "bn_common.h"
+#include "bn_timer.h"
+
+// Measures the frame budget left when the flag is updated (with VCOUNT and a timer)
+// and lowers the quality level when it doesn't fit, restoring it when there's headroom again
+class adaptive_quality
+{
+
+public:
+    enum class level : uint8_t
+    {
+        FULL,               // Every column is updated every frame
+        HALF_RATE,          // Half of the columns are updated every frame, so the flag moves every other frame
+        HOLD                // The displayed frame is kept
+    };
+
+    // Frames with enough headroom needed before restoring one level
+    static constexpr int restore_frames = 30;
+
+    [[nodiscard]] static const char* level_name(level value);
+
+    [[nodiscard]] level current_level() const
+    {
+        return _level;
+    }
+
+    [[nodiscard]] int full_update_cycles() const
+    {
+        return _full_update_cycles;
+    }
+
+    // Updates the quality level and returns the work to do this frame: FULL, HALF_RATE or HOLD
+    [[nodiscard]] level begin_update();
+
+    // Reports the number of columns updated since begin_update(), to refine the cost estimates
+    void end_update(int columns_updated, int total_columns);
+
+private:
+    bn::timer _frame_timer;
+    bn::timer _update_timer;
+    int _full_update_cycles = 48000;
+    int _headroom_frames = 0;
+    level _level = level::FULL;
+
+    [[nodiscard]] int _level_cycles(level value) const;
+
+    void _set_level(level value, int remaining_cycles);
+};
+
+#endif
@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------------
+// arm_functions.h
+//--------------------------------------------------------------------------------
+// Declarations of the hand-written ARM routines
+//--------------------------------------------------------------------------------
+
+#ifndef ARM_FUNCTIONS_H
+#define ARM_FUNCTIONS_H
+
+#include "bn_common.h"
+
+struct copy_command;
+
+namespace arm
+{
+    // Copies a vertical strip from a background originally formatted to be 32x32 horizontal
+    // into a vertically-oriented tile map; will basically copy a tile strip in a contiguous
+    // version of memory. This is needed to deal with Butano's formatting tool that only exports
+    // tiles in row-major order, not allowing to export in column-major order
+    BN_CODE_IWRAM void copy_vertical_tile_strip_8bpp(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles);
+
+    // Unrolled variants of copy_vertical_tile_strip_8bpp, which load the next map cell while copying a tile.
+    // num_tiles must be a multiple of 2 and 4 respectively, and the last one always copies 16 tiles
+    BN_CODE_IWRAM void copy_vertical_tile_strip_8bpp_x2(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles);
+
+    BN_CODE_IWRAM void copy_vertical_tile_strip_8bpp_x4(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles);
+
+    BN_CODE_IWRAM void copy_vertical_tile_strip_8bpp_16(void* dest, const void* src, const uint16_t* map_cells);
+
+    // Same as copy_vertical_tile_strip_8bpp, but honouring the flip bits of the map cells.
+    // Unflipped tiles only pay for the check of the flip bits
+    BN_CODE_IWRAM void copy_vertical_tile_strip_8bpp_flipped(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles);
+
+    // Calls the fastest copy_vertical_tile_strip_8bpp variant for the given number of tiles,
+    // or the flip-aware one if there are flipped tiles
+    inline void copy_vertical_tile_strip_8bpp_fastest(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles, bool flipped = false)
+    {
+        if(flipped)
+        {
+            copy_vertical_tile_strip_8bpp_flipped(dest, src, map_cells, num_tiles);
+        }
+        else if(num_tiles == 16)
+        {
+            copy_vertical_tile_strip_8bpp_16(dest, src, map_cells);
+        }
+        else if(num_tiles % 4 == 0)
+        {
+            copy_vertical_tile_strip_8bpp_x4(dest, src, map_cells, num_tiles);
+        }
+        else if(num_tiles % 2 == 0)
+        {
+            copy_vertical_tile_strip_8bpp_x2(dest, src, map_cells, num_tiles);
+        }
+        else
+        {
+            copy_vertical_tile_strip_8bpp(dest, src, map_cells, num_tiles);
+        }
+    }
+
+    // Horizontal counterpart of copy_vertical_tile_strip_8bpp: copies a row of tiles of a background into
+    // a row of contiguous tiles, moving it shift pixels (0 to 7) to the right. num_tiles + 1 tiles are written,
+    // since the pixels pushed out of the last tile go to the next one
+    BN_CODE_IWRAM void copy_horizontal_tile_strip_8bpp(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles, int shift);
+
+    // Same as copy_horizontal_tile_strip_8bpp, but honouring the flip bits of the map cells
+    BN_CODE_IWRAM void copy_horizontal_tile_strip_8bpp_flipped(
+            void* dest, const void* src, const uint16_t* map_cells, int num_tiles, int shift);
+
+    // Same as copy_horizontal_tile_strip_8bpp, but reading column-major tiles: the lines of each column
+    // are read from column_lines[column] + line_offset bytes on, so every column can be moved vertically too
+    BN_CODE_IWRAM void copy_displaced_tile_strip_8bpp(
+            void* dest, const void* const* column_lines, int line_offset, int num_tiles, int shift);
+
+    // Executes a list of linear word copies (see copy_list), using 8-register bursts
+    BN_CODE_IWRAM void execute_copy_commands(const copy_command* commands, int count);
+}
+
+#endif
@@ -0,0 +1,16 @@
+//--------------------------------------------------------------------------------
+// benchmark.h
+//--------------------------------------------------------------------------------
+// Benchmark ROM entry point (build with USERFLAGS += -DBENCHMARK)
+//--------------------------------------------------------------------------------
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+namespace benchmark
+{
+    // Measures the flag effect pieces, logging the results and asserting their cycle budgets
+    void run();
+}
+
+#endif
@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------
+// cloth_simulation.h
+//--------------------------------------------------------------------------------
+// Fixed-point Verlet simulation that can drive the flag columns
+//--------------------------------------------------------------------------------
+
+#ifndef CLOTH_SIMULATION_H
+#define CLOTH_SIMULATION_H
+
+#include "bn_assert.h"
+#include "bn_algorithm.h"
+#include "flag_data.h"
+
+// A string of nodes (one per flag column) joined by springs. Node 0 is attached to the pole and
+// is swung by the wind, the rest follow it, and the last one hangs free
+class cloth_simulation
+{
+
+public:
+    static constexpr int nodes_count = data::flag_width_tiles;
+    static constexpr int max_wind = data::max_column_displacement;
+
+    cloth_simulation()
+    {
+        int8_t displacements[nodes_count] = {};
+        reset(displacements);
+    }
+
+    [[nodiscard]] int wind() const
+    {
+        return _wind;
+    }
+
+    // Sets the amplitude in pixels of the pole end swing
+    void set_wind(int wind)
+    {
+        _wind = bn::clamp(wind, 0, max_wind);
+    }
+
+    // Adds the given velocity (in pixels per frame) to a node
+    void apply_impulse(int node, int velocity)
+    {
+        BN_ASSERT(node > 0 && node < nodes_count, "Invalid node: ", node);
+
+        _nodes[_current ^ 1][node] -= velocity << fraction_bits;
+    }
+
+    // Places the nodes at rest at the given displacements, so enabling the simulation doesn't make the flag jump
+    void reset(const int8_t* displacements)
+    {
+        for(int node = 0; node < nodes_count; ++node)
+        {
+            int position = displacements[node] << fraction_bits;
+            _nodes[0][node] = position;
+            _nodes[1][node] = position;
+            _displacements[node] = displacements[node];
+        }
+    }
+
+    // Displacement in pixels of the given node, in the [-max_column_displacement, max_column_displacement] range
+    [[nodiscard]] int displacement(int node) const
+    {
+        return _displacements[node];
+    }
+
+    // Advances the simulation one frame
+    BN_CODE_IWRAM void update();
+
+private:
+    static constexpr int fraction_bits = 8;
+    static constexpr int stiffness = 4;         // Out of 256: waves travel 1/8 node per frame, like the sine wave
+    static constexpr int damping = 254;         // Out of 256
+
+    // Two sets of positions (current and previous), with an extra ghost node at the free end
+    int _nodes[2][nodes_count + 1];
+    int8_t _displacements[nodes_count];
+    int _current = 0;
+    int _wind = data::wave_vertical_amplitude;
+    int _phase = 0;
+};
+
+#endif
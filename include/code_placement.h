@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------
+// code_placement.h
+//--------------------------------------------------------------------------------
+// Build-time placement of the hot C++ functions
+//--------------------------------------------------------------------------------
+
+#ifndef CODE_PLACEMENT_H
+#define CODE_PLACEMENT_H
+
+// C++ code runs from ROM as Thumb by default. Each hot function can be moved to IWRAM and compiled as ARM
+// with a flag, so the benchmark ROM can compare every combination (USERFLAGS += -DBENCHMARK -D...):
+// - FLAG_UPDATE_IWRAM: flag_bg::update, with the wave lookups inlined in it.
+// - STRIP_UPDATE_IWRAM: strip_displacement_bg::update and replay, with the strip copy queueing inlined in them.
+// The hand-written copy routines are ARM code, so they are always in IWRAM.
+// IWRAM functions aren't inlined into their callers, otherwise they would end up in ROM again
+#define CODE_PLACEMENT_IWRAM_ARM __attribute__((section(".iwram.code_placement"), target("arm"), noinline))
+
+#ifdef FLAG_UPDATE_IWRAM
+    #define FLAG_UPDATE_CODE CODE_PLACEMENT_IWRAM_ARM
+#else
+    #define FLAG_UPDATE_CODE
+#endif
+
+#ifdef STRIP_UPDATE_IWRAM
+    #define STRIP_UPDATE_CODE CODE_PLACEMENT_IWRAM_ARM
+#else
+    #define STRIP_UPDATE_CODE
+#endif
+
+namespace code_placement
+{
+    // Name of the build variant, to label the benchmark results
+    #if defined(FLAG_UPDATE_IWRAM) && defined(STRIP_UPDATE_IWRAM)
+        constexpr const char* name = "flag and strip updates in IWRAM";
+    #elif defined(FLAG_UPDATE_IWRAM)
+        constexpr const char* name = "flag update in IWRAM";
+    #elif defined(STRIP_UPDATE_IWRAM)
+        constexpr const char* name = "strip update in IWRAM";
+    #else
+        constexpr const char* name = "everything in ROM";
+    #endif
+}
+
+#endif
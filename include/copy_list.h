@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------------
+// copy_list.h
+//--------------------------------------------------------------------------------
+// Batched word copies executed with a single call
+//--------------------------------------------------------------------------------
+
+#ifndef COPY_LIST_H
+#define COPY_LIST_H
+
+#include "bn_assert.h"
+
+#include "arm_functions.h"
+
+// A linear copy of 32-bit words; source and destination must be word aligned and can't overlap
+struct copy_command
+{
+    const void* src;
+    void* dest;
+    int words;
+};
+
+// 8bpp tile filled with zeros, to clear VRAM with copy commands
+extern const uint32_t blank_tile_8bpp[16];
+
+// Copies are collected while computing a frame and executed all at once,
+// either by an IWRAM routine or by DMA
+class copy_list
+{
+
+public:
+    // Enough for a strip copy and a padding clear per strip
+    static constexpr int max_size = 64;
+
+    [[nodiscard]] int size() const
+    {
+        return _size;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return ! _size;
+    }
+
+    [[nodiscard]] bool full() const
+    {
+        return _size == max_size;
+    }
+
+    // Words pushed since the list was created, including the ones already executed
+    [[nodiscard]] int words() const
+    {
+        return _words;
+    }
+
+    void push_back(const void* src, void* dest, int words)
+    {
+        BN_ASSERT(! full(), "Copy list is full");
+
+        _commands[_size] = copy_command{ src, dest, words };
+        ++_size;
+        _words += words;
+    }
+
+    // Executes the commands with the CPU and clears the list
+    void execute()
+    {
+        arm::execute_copy_commands(_commands, _size);
+        _size = 0;
+    }
+
+    // Executes the commands with DMA channel 3 and clears the list
+    void execute_dma();
+
+private:
+    copy_command _commands[max_size];
+    int _size = 0;
+    int _words = 0;
+};
+
+#endif
@@ -0,0 +1,41 @@
+//--------------------------------------------------------------------------------
+// cpu_cycles.h
+//--------------------------------------------------------------------------------
+// Conversions between timer ticks, scanlines and CPU cycles
+//--------------------------------------------------------------------------------
+
+#ifndef CPU_CYCLES_H
+#define CPU_CYCLES_H
+
+#include "bn_common.h"
+#include "bn_timers.h"
+
+namespace cpu_cycles
+{
+    // The GBA CPU runs 1232 cycles per scanline and 228 scanlines per frame
+    constexpr int per_scanline = 1232;
+    constexpr int per_frame = per_scanline * 228;
+
+    // Converts bn::timer ticks into CPU cycles
+    [[nodiscard]] constexpr int from_ticks(int ticks)
+    {
+        return int((int64_t(ticks) * per_frame) / bn::timers::ticks_per_frame());
+    }
+
+    // Returns the scanline being drawn (VCOUNT register)
+    [[nodiscard]] inline int current_scanline()
+    {
+        return *reinterpret_cast<volatile uint16_t*>(0x04000006);
+    }
+
+    // Returns the CPU cycles left before the next VBlank starts
+    [[nodiscard]] inline int remaining_in_frame()
+    {
+        // Inside VBlank the next frame hasn't been drawn yet, so there's a whole display period ahead
+        int scanline = current_scanline();
+        int lines = scanline < 160 ? 160 - scanline : 160 + 228 - scanline;
+        return lines * per_scanline;
+    }
+}
+
+#endif
@@ -0,0 +1,164 @@
+//--------------------------------------------------------------------------------
+// flag_bg.h
+//--------------------------------------------------------------------------------
+// Waving flag background
+//--------------------------------------------------------------------------------
+
+#ifndef FLAG_BG_H
+#define FLAG_BG_H
+
+#include "bn_assert.h"
+#include "bn_optional.h"
+
+#include "flag_data.h"
+#include "wave_clock.h"
+#include "cloth_simulation.h"
+#include "adaptive_quality.h"
+#include "code_placement.h"
+#include "telemetry.h"
+#include "strip_displacement_bg.h"
+
+// Moves the columns of a strip_displacement_bg with a sine wave or a cloth simulation.
+// Flags can be switched at once, wiped or crossfaded. A wipe reveals the incoming flag a few columns per update.
+// During a crossfade, the incoming flag is drawn into a second background that moves with
+// the same displacements, and both are alpha blended
+class flag_bg
+{
+
+public:
+    [[nodiscard]] static flag_bg create(const bn::regular_bg_item& bg_item);
+
+    [[nodiscard]] const bn::regular_bg_item& bg_item() const
+    {
+        return _strips->item();
+    }
+
+    void set_bg_item(const bn::regular_bg_item& bg_item)
+    {
+        BN_ASSERT(! crossfading(), "Can't switch flags while crossfading");
+
+        _strips->set_item(bg_item);
+    }
+
+    [[nodiscard]] bool crossfading() const
+    {
+        return _incoming_strips.has_value();
+    }
+
+    [[nodiscard]] bool wiping() const
+    {
+        return _strips->revealing();
+    }
+
+    [[nodiscard]] bool transitioning() const
+    {
+        return crossfading() || wiping();
+    }
+
+    // Reveals the given flag from left to right, data::wipe_columns_per_update columns per update.
+    // Both flags must share the palette
+    void wipe_to(const bn::regular_bg_item& bg_item)
+    {
+        BN_ASSERT(! crossfading(), "Can't wipe while crossfading");
+
+        _strips->reveal_item(bg_item, data::wipe_columns_per_update);
+    }
+
+    // Crossfades to the given flag in the given number of updates. Both flags must share the palette.
+    // Its cost isn't spread like a wipe's: this call creates both backgrounds and transfers both flags whole,
+    // and the last update recreates the double buffered one, transferring the incoming flag again
+    void crossfade_to(const bn::regular_bg_item& bg_item, int frames = data::crossfade_frames);
+
+    // Background VRAM and palette colors taken, including the incoming flag of a crossfade
+    [[nodiscard]] vram_budget::usage vram_usage() const;
+
+    // When the cloth simulation is enabled, it drives the columns instead of the sine wave
+    [[nodiscard]] bool cloth_enabled() const
+    {
+        return _cloth_enabled;
+    }
+
+    void set_cloth_enabled(bool cloth_enabled);
+
+    [[nodiscard]] cloth_simulation& cloth()
+    {
+        return _cloth;
+    }
+
+    // When the adaptive mode is enabled, the work done each frame depends on the remaining frame budget
+    [[nodiscard]] bool adaptive_enabled() const
+    {
+        return _adaptive_enabled;
+    }
+
+    void set_adaptive_enabled(bool adaptive_enabled);
+
+    [[nodiscard]] const adaptive_quality& quality() const
+    {
+        return _quality;
+    }
+
+    // When DMA is enabled, the copy commands are executed with DMA instead of the CPU
+    [[nodiscard]] bool dma_enabled() const
+    {
+        return _strips->dma_enabled();
+    }
+
+    void set_dma_enabled(bool dma_enabled)
+    {
+        _strips->set_dma_enabled(dma_enabled);
+
+        if(_incoming_strips)
+        {
+            _incoming_strips->set_dma_enabled(dma_enabled);
+        }
+    }
+
+    // When the schedule is enabled and the flag follows the sine wave one frame at a time,
+    // update() replays precomputed column deltas instead of computing them
+    [[nodiscard]] bool schedule_enabled() const
+    {
+        return _schedule_enabled;
+    }
+
+    void set_schedule_enabled(bool schedule_enabled);
+
+    FLAG_UPDATE_CODE void update();
+
+    // Bytes written to VRAM by the copy commands of the last update
+    [[nodiscard]] int copied_bytes() const
+    {
+        return _copied_bytes;
+    }
+
+private:
+    bn::optional<strip_displacement_bg> _strips;
+    bn::optional<strip_displacement_bg> _incoming_strips;
+    cloth_simulation _cloth;
+    adaptive_quality _quality;
+    wave_clock _clock;
+    int _current_frame = 0;
+    int _copied_bytes = 0;
+    bool _cloth_enabled = false;
+    bool _adaptive_enabled = false;
+    bool _schedule_enabled = false;
+    bool _back_buffer_half_updated = false;
+
+    // Frame each buffer was last updated for, and if it's exactly at the sine wave displacements of that frame
+    int _buffer_frames[2] = { 0, 0 };
+    bool _wave_synced[2] = { true, true };
+
+    // Crossfade length and progress, in updates
+    int _crossfade_frames = 0;
+    int _crossfade_frame = 0;
+
+    explicit flag_bg(strip_displacement_bg&& strips);
+
+    // Updates both flags of the crossfade and returns the bytes copied
+    int _update_crossfade(int current_frame);
+
+    // Stores the stats of this update when telemetry is enabled
+    void _push_telemetry(int simulation_cycles, int strips_cycles, int columns_updated, bool crossfading) const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------------
+// flag_data.h
+//--------------------------------------------------------------------------------
+// Flag geometry and wave parameters
+//--------------------------------------------------------------------------------
+
+#ifndef FLAG_DATA_H
+#define FLAG_DATA_H
+
+#include "vram_budget.h"
+
+namespace data
+{
+    // Flag dimensions
+    constexpr int flag_width_pixels = 192;
+    constexpr int flag_height_pixels = 128;
+    constexpr int flag_width_tiles = flag_width_pixels/8;
+    constexpr int flag_height_tiles = flag_height_pixels/8;
+
+    // The flag should be centered
+    constexpr int flag_offset_x = (32 - flag_width_tiles)/2;
+    constexpr int flag_offset_y = (32 - flag_height_tiles)/2;
+
+    // One strip per tile column
+    constexpr strip_layout flag_layout = { flag_offset_x, flag_offset_y, flag_width_tiles, flag_height_tiles };
+
+    // Allocation numbers
+    constexpr int flag_tiles_needed = flag_layout.buffer_tiles();
+
+    // Every flag shares the same palette, which only has the colors they use (see graphics/*.json)
+    constexpr int flag_palette_colors = 160;
+
+    // A flag is double buffered. During a crossfade, there are two single buffered flags with the same palette
+    constexpr vram_budget::usage flag_vram_usage = vram_budget::strip_usage(flag_layout, 2, flag_palette_colors);
+    constexpr vram_budget::usage crossfade_vram_usage = {
+        2 * vram_budget::strip_usage(flag_layout, 1, flag_palette_colors).tiles_bytes,
+        2 * vram_budget::map_bytes,
+        flag_palette_colors
+    };
+    static_assert(flag_vram_usage.free_vram_bytes() >= 0, "The flag doesn't fit in VRAM");
+    static_assert(crossfade_vram_usage.free_vram_bytes() >= 0, "The crossfade doesn't fit in VRAM");
+
+    // Important data to generate the LUT
+    constexpr int wave_vertical_amplitude = 4;
+    constexpr int wave_horizontal_period = 128;
+    constexpr int wave_horizontal_multiplier = 2048 / wave_horizontal_period;
+    static_assert((wave_horizontal_period & (wave_horizontal_period - 1)) == 0, "The period must be a power of two");
+
+    // Frames the wave can advance in one update after the game drops frames
+    constexpr int max_catch_up_frames = 8;
+
+    // Column movement limits
+    constexpr int max_column_delta = strip_layout::max_delta;
+    constexpr int max_column_displacement = strip_layout::max_displacement;
+    static_assert(wave_vertical_amplitude <= max_column_displacement);
+
+    // Flag transitions
+    constexpr int crossfade_frames = 32;
+    constexpr int wipe_columns_per_update = 1;
+
+    // CPU cycles allowed for one step of the cloth simulation
+    constexpr int cloth_cycle_budget = 2048;
+}
+
+#endif
@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------
+// grid_displacement_bg.h
+//--------------------------------------------------------------------------------
+// Background whose columns move up and down and whose rows move left and right
+//--------------------------------------------------------------------------------
+
+#ifndef GRID_DISPLACEMENT_BG_H
+#define GRID_DISPLACEMENT_BG_H
+
+#include "bn_tile.h"
+#include "bn_array.h"
+#include "bn_vector.h"
+#include "bn_algorithm.h"
+#include "bn_unique_ptr.h"
+#include "bn_regular_bg_ptr.h"
+#include "bn_regular_bg_item.h"
+#include "bn_regular_bg_map_ptr.h"
+
+#include "strip_layout.h"
+
+// Combines strip_displacement_bg and row_displacement_bg in a single pass.
+// The item is copied once into a column-major EWRAM buffer, so a vertical offset is a pointer offset,
+// and every update draws the rows of the region from it with arm::copy_displaced_tile_strip_8bpp,
+// moving each column vertically and each row horizontally at the same time.
+// The EWRAM buffer is allocated in the heap by create(), so it only takes memory while the background exists
+class grid_displacement_bg
+{
+
+public:
+    static constexpr int max_columns = 32;
+    static constexpr int max_rows = 32;
+    static constexpr int min_offset = -8;
+    static constexpr int max_offset = 7;
+    static constexpr int max_vertical_offset = 8;
+
+    [[nodiscard]] static grid_displacement_bg create(const bn::regular_bg_item& item, const strip_layout& layout);
+
+    [[nodiscard]] const bn::regular_bg_item& item() const
+    {
+        return *_item;
+    }
+
+    // The new item is drawn by the next update
+    void set_item(const bn::regular_bg_item& item);
+
+    [[nodiscard]] const strip_layout& layout() const
+    {
+        return _layout;
+    }
+
+    [[nodiscard]] const bn::regular_bg_ptr& bg() const
+    {
+        return _bg;
+    }
+
+    [[nodiscard]] bn::regular_bg_ptr& bg()
+    {
+        return _bg;
+    }
+
+    // Draws each strip moved column_offset_provider(strip) pixels down (clamped to +-max_vertical_offset)
+    // and each tile row moved row_offset_provider(row) pixels to the right (clamped to [min_offset, max_offset]),
+    // and displays the result
+    template<typename ColumnOffsetProvider, typename RowOffsetProvider>
+    void update(const ColumnOffsetProvider& column_offset_provider, const RowOffsetProvider& row_offset_provider)
+    {
+        int8_t column_offsets[max_columns];
+        int8_t row_offsets[max_rows];
+
+        for(int column = 0, columns = _layout.width; column < columns; ++column)
+        {
+            column_offsets[column] = int8_t(bn::clamp(int(column_offset_provider(column / _layout.strip_width)),
+                                                      -max_vertical_offset, max_vertical_offset));
+        }
+
+        for(int row = 0, rows = _layout.height; row < rows; ++row)
+        {
+            row_offsets[row] = int8_t(bn::clamp(int(row_offset_provider(row)), min_offset, max_offset));
+        }
+
+        _draw(column_offsets, row_offsets);
+    }
+
+private:
+    // 8bpp tiles of the column-major copy of the item
+    static constexpr int max_source_tiles = 512;
+
+    // Blank tile, the columns one after the other with a blank tile above and below each one, and a blank tile
+    // (2 * 4bpp tiles for each 8bpp tile)
+    using source_tiles_type = bn::array<bn::tile, 2 * max_source_tiles>;
+
+    const bn::regular_bg_item* _item;
+    strip_layout _layout;
+    bn::regular_bg_ptr _bg;
+    bn::vector<bn::regular_bg_map_ptr, 2> _maps;
+    bn::unique_ptr<source_tiles_type> _source_tiles;
+    int _displayed_buffer = 0;
+
+    grid_displacement_bg(const bn::regular_bg_item& item, const strip_layout& layout, bn::regular_bg_ptr&& bg,
+                         bn::vector<bn::regular_bg_map_ptr, 2>&& maps,
+                         bn::unique_ptr<source_tiles_type>&& source_tiles);
+
+    // Tiles of each row, including the left and right padding
+    [[nodiscard]] static constexpr int _row_tiles(const strip_layout& layout)
+    {
+        return layout.width + 2;
+    }
+
+    // Tile rows of the region, including the top and bottom padding
+    [[nodiscard]] static constexpr int _rows(const strip_layout& layout)
+    {
+        return layout.height + 2;
+    }
+
+    // 8bpp tiles of each of the two buffers
+    [[nodiscard]] static constexpr int _buffer_tiles(const strip_layout& layout)
+    {
+        return _rows(layout) * _row_tiles(layout);
+    }
+
+    // Copies the item into the column-major EWRAM buffer
+    void _load_item();
+
+    // Draws the region into the buffer which isn't displayed and displays it
+    void _draw(const int8_t* column_offsets, const int8_t* row_offsets);
+};
+
+#endif
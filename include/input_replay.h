@@ -0,0 +1,41 @@
+//--------------------------------------------------------------------------------
+// input_replay.h
+//--------------------------------------------------------------------------------
+// Keypad input of the main loop, live or replayed from a script
+//--------------------------------------------------------------------------------
+
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include "bn_keypad.h"
+
+// The main loop reads its keys from here instead of bn::keypad.
+// The benchmark ROM (USERFLAGS += -DBENCHMARK) ignores the keypad and replays data::input_script,
+// so the same keys are pressed at the same frames every run and measurements can be compared across builds.
+// With USERFLAGS += -DINPUT_RECORD, live presses are logged as script events, ready to be pasted in the script
+namespace input_replay
+{
+    #ifdef BENCHMARK
+        constexpr bool replaying = true;
+    #else
+        constexpr bool replaying = false;
+    #endif
+
+    // A key pressed at the given frame of the main loop (the first one is frame 0)
+    struct event
+    {
+        int frame;
+        bn::keypad::key_type key;
+    };
+
+    // Advances to the next frame: it must be called once per frame, before any pressed() call
+    void update();
+
+    // Frame of the main loop, counted from the first update() call
+    [[nodiscard]] int frame();
+
+    // If the given key has been pressed in this frame
+    [[nodiscard]] bool pressed(bn::keypad::key_type key);
+}
+
+#endif
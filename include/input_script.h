@@ -0,0 +1,39 @@
+//--------------------------------------------------------------------------------
+// input_script.h
+//--------------------------------------------------------------------------------
+// Input replayed by the benchmark ROM
+//--------------------------------------------------------------------------------
+
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include "input_replay.h"
+
+namespace data
+{
+    // Goes through every transition, the cloth simulation, the adaptive mode and the schedule.
+    // Events must be sorted by frame
+    constexpr input_replay::event input_script[] = {
+        { 120, bn::keypad::key_type::A },           // Switch to the US flag at once
+        { 240, bn::keypad::key_type::START },       // Select the wipe
+        { 300, bn::keypad::key_type::A },           // and wipe to the Brazil flag
+        { 420, bn::keypad::key_type::START },       // Select the crossfade
+        { 480, bn::keypad::key_type::A },           // and crossfade to the US flag
+        { 600, bn::keypad::key_type::SELECT },      // Enable the cloth simulation
+        { 660, bn::keypad::key_type::RIGHT },       // Blow some wind
+        { 720, bn::keypad::key_type::B },           // Push the flag
+        { 780, bn::keypad::key_type::A },           // Crossfade to the Brazil flag while simulating
+        { 900, bn::keypad::key_type::SELECT },      // Back to the sine wave
+        { 960, bn::keypad::key_type::L },           // Enable the adaptive mode
+        { 1080, bn::keypad::key_type::L },          // and disable it
+        { 1140, bn::keypad::key_type::R },          // Enable the schedule
+        { 1200, bn::keypad::key_type::START },      // Select the instant switch
+        { 1260, bn::keypad::key_type::A },          // and switch to the US flag
+        { 1380, bn::keypad::key_type::R }           // Disable the schedule
+    };
+
+    // Frames until the script is finished, leaving time for the last event to settle
+    constexpr int input_script_frames = 1500;
+}
+
+#endif
@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------
+// perf_hud.h
+//--------------------------------------------------------------------------------
+// On-screen performance overlay
+//--------------------------------------------------------------------------------
+
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include "bn_vector.h"
+#include "bn_sprite_ptr.h"
+
+// Shows the cost of the flag with 8x8 sprites and a tiny digit font, since the 8bpp flag takes
+// the whole background palette and most of the background VRAM:
+// C: current flag_bg::update cycles, P: peak cycles since the overlay was created,
+// V: VCOUNT when the update finished (160 or more means it ran into VBlank),
+// B: bytes written to VRAM by the update.
+// The numbers are only redrawn every refresh_frames updates, so the overlay costs almost nothing
+class perf_hud
+{
+
+public:
+    static constexpr int refresh_frames = 16;
+    static constexpr int max_sprites = 32;
+
+    [[nodiscard]] static perf_hud create();
+
+    // Reports the stats of the last update, and redraws the numbers when it's time to do it
+    void update(int update_cycles, int end_scanline, int copied_bytes);
+
+private:
+    bn::vector<bn::sprite_ptr, max_sprites> _sprites;
+    uint8_t _glyphs[max_sprites] = {};
+    int _frames = 0;
+    int _peak_cycles = 0;
+
+    explicit perf_hud(bn::vector<bn::sprite_ptr, max_sprites>&& sprites);
+
+    // Writes the given value right aligned into the digit sprites of a field
+    void _set_number(int field, int value);
+};
+
+#endif
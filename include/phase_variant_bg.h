@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------------
+// phase_variant_bg.h
+//--------------------------------------------------------------------------------
+// Background whose tile columns are moved up and down only with map cells
+//--------------------------------------------------------------------------------
+
+#ifndef PHASE_VARIANT_BG_H
+#define PHASE_VARIANT_BG_H
+
+#include "bn_algorithm.h"
+#include "bn_unique_ptr.h"
+#include "bn_regular_bg_ptr.h"
+#include "bn_regular_bg_item.h"
+#include "bn_regular_bg_map_ptr.h"
+
+#include "strip_map.h"
+#include "vram_budget.h"
+#include "strip_layout.h"
+
+// Each tile column of the region is stored in VRAM 8 times, moved down 0 to 7 pixels (its phases),
+// so any displacement is a tile offset plus a phase, and moving a column only rewrites its map cells.
+// Each phase takes a tile more than the column, since its last lines are pushed into it.
+// That's 8 * (height + 1) tiles per column, so it only fits small regions:
+// a 6x16 region takes 817 8bpp tiles, and the 24x16 flag would need 3265.
+// Displacements go from -layout.max_total_displacement() to layout.max_total_displacement(), without per-frame
+// limit, and the layout strip_width is the number of tile columns moved together.
+// The map is a copy in EWRAM which is regenerated by an IWRAM routine every update
+// and uploaded by butano in the next VBlank, so there's a single map in VRAM
+class phase_variant_bg
+{
+
+public:
+    static constexpr int phases = 8;
+    static constexpr int max_columns = 32;
+
+    // 8bpp tiles allocated: the phases of every column and a blank tile for the rest of the map
+    [[nodiscard]] static constexpr int allocated_tiles(const strip_layout& layout)
+    {
+        return layout.width * phases * (layout.height + 1) + 1;
+    }
+
+    // Background VRAM and palette colors taken by the given layout (tiles and the map)
+    [[nodiscard]] static constexpr vram_budget::usage vram_usage(const strip_layout& layout, int palette_colors)
+    {
+        return { 64 * allocated_tiles(layout), vram_budget::map_bytes, palette_colors };
+    }
+
+    // If the given layout fits in the background VRAM and in the tile indexes of a map
+    [[nodiscard]] static constexpr bool fits(const strip_layout& layout)
+    {
+        return allocated_tiles(layout) <= 1024 && vram_usage(layout, 0).free_vram_bytes() >= 0;
+    }
+
+    [[nodiscard]] static phase_variant_bg create(const bn::regular_bg_item& item, const strip_layout& layout);
+
+    [[nodiscard]] const bn::regular_bg_item& item() const
+    {
+        return *_item;
+    }
+
+    // Draws every phase of the new item
+    void set_item(const bn::regular_bg_item& item)
+    {
+        _item = &item;
+        _transfer();
+    }
+
+    [[nodiscard]] const strip_layout& layout() const
+    {
+        return _layout;
+    }
+
+    [[nodiscard]] const bn::regular_bg_ptr& bg() const
+    {
+        return _bg;
+    }
+
+    [[nodiscard]] bn::regular_bg_ptr& bg()
+    {
+        return _bg;
+    }
+
+    [[nodiscard]] vram_budget::usage vram_usage() const
+    {
+        return vram_usage(_layout, _item->palette_item().colors_ref().size());
+    }
+
+    // Moves each strip offset_provider(strip) pixels down (clamped to the layout limits).
+    // The map is displayed in the next VBlank
+    template<typename OffsetProvider>
+    void update(const OffsetProvider& offset_provider)
+    {
+        int max_disp = _layout.max_total_displacement();
+
+        for(int strip = 0, strips = _layout.strips(); strip < strips; ++strip)
+        {
+            _displacements[strip] = int8_t(bn::clamp(int(offset_provider(strip)), -max_disp, max_disp));
+        }
+
+        _generate_cells();
+        _map.reload_cells_ref();
+    }
+
+private:
+    const bn::regular_bg_item* _item;
+    strip_layout _layout;
+    bn::unique_ptr<strip_map::cells_type> _cells;
+    bn::regular_bg_map_ptr _map;
+    bn::regular_bg_ptr _bg;
+
+    // Current displacement of each strip
+    int8_t _displacements[max_columns] = {};
+
+    // First tile of each phase of each column, so the cells are generated without multiplications
+    int16_t _phase_tiles[max_columns][phases] = {};
+
+    phase_variant_bg(const bn::regular_bg_item& item, const strip_layout& layout,
+                     bn::unique_ptr<strip_map::cells_type>&& cells, bn::regular_bg_map_ptr&& map,
+                     bn::regular_bg_ptr&& bg);
+
+    // First tile of the given phase of the given column
+    [[nodiscard]] static constexpr int _phase_tile(const strip_layout& layout, int column, int phase)
+    {
+        return (column * phases + phase) * (layout.height + 1) + 1;
+    }
+
+    // Writes every column of the region into the map cells at its current displacement:
+    // a column is the tiles of its phase, with blank cells above and below it
+    BN_CODE_IWRAM void _generate_cells();
+
+    // Draws every phase of every column of the item
+    void _transfer();
+};
+
+#endif
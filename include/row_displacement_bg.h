@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------------
+// row_displacement_bg.h
+//--------------------------------------------------------------------------------
+// Background whose tile rows can be moved left and right independently
+//--------------------------------------------------------------------------------
+
+#ifndef ROW_DISPLACEMENT_BG_H
+#define ROW_DISPLACEMENT_BG_H
+
+#include "bn_vector.h"
+#include "bn_algorithm.h"
+#include "bn_regular_bg_ptr.h"
+#include "bn_regular_bg_item.h"
+#include "bn_regular_bg_map_ptr.h"
+
+#include "strip_layout.h"
+
+// Horizontal counterpart of strip_displacement_bg. Each tile row of the region is stored contiguously
+// with a padding tile at both sides, and it's redrawn from the item every update with
+// arm::copy_horizontal_tile_strip_8bpp, so offsets are absolute and don't have a per-frame limit.
+// The layout strip_width is the number of tile rows moved together
+class row_displacement_bg
+{
+
+public:
+    static constexpr int max_rows = 32;
+    static constexpr int min_offset = -8;
+    static constexpr int max_offset = 7;
+
+    [[nodiscard]] static row_displacement_bg create(const bn::regular_bg_item& item, const strip_layout& layout);
+
+    [[nodiscard]] const bn::regular_bg_item& item() const
+    {
+        return *_item;
+    }
+
+    // The new item is drawn by the next update
+    void set_item(const bn::regular_bg_item& item);
+
+    [[nodiscard]] const strip_layout& layout() const
+    {
+        return _layout;
+    }
+
+    [[nodiscard]] const bn::regular_bg_ptr& bg() const
+    {
+        return _bg;
+    }
+
+    [[nodiscard]] bn::regular_bg_ptr& bg()
+    {
+        return _bg;
+    }
+
+    // Draws each strip moved offset_provider(strip) pixels to the right (clamped to [min_offset, max_offset])
+    // and displays the result
+    template<typename OffsetProvider>
+    void update(const OffsetProvider& offset_provider)
+    {
+        int8_t offsets[max_rows];
+
+        for(int row = 0, rows = _layout.height; row < rows; ++row)
+        {
+            offsets[row] = int8_t(bn::clamp(int(offset_provider(row / _layout.strip_width)), min_offset, max_offset));
+        }
+
+        _draw(offsets);
+    }
+
+private:
+    const bn::regular_bg_item* _item;
+    strip_layout _layout;
+    bn::regular_bg_ptr _bg;
+    bn::vector<bn::regular_bg_map_ptr, 2> _maps;
+    int _displayed_buffer = 0;
+    bool _item_flipped = false;     // If the item has flipped tiles, which need the flip-aware copy routine
+
+    row_displacement_bg(const bn::regular_bg_item& item, const strip_layout& layout, bn::regular_bg_ptr&& bg,
+                        bn::vector<bn::regular_bg_map_ptr, 2>&& maps);
+
+    // Tiles of each row, including the left and right padding
+    [[nodiscard]] static constexpr int _row_tiles(const strip_layout& layout)
+    {
+        return layout.width + 2;
+    }
+
+    // 8bpp tiles of each of the two buffers
+    [[nodiscard]] static constexpr int _buffer_tiles(const strip_layout& layout)
+    {
+        return layout.height * _row_tiles(layout);
+    }
+
+    // Draws the rows into the buffer which isn't displayed and displays it
+    void _draw(const int8_t* offsets);
+};
+
+#endif
@@ -0,0 +1,435 @@
+//--------------------------------------------------------------------------------
+// strip_displacement_bg.h
+//--------------------------------------------------------------------------------
+// Background whose vertical strips can be moved up and down independently
+//--------------------------------------------------------------------------------
+
+#ifndef STRIP_DISPLACEMENT_BG_H
+#define STRIP_DISPLACEMENT_BG_H
+
+#include "bn_math.h"
+#include "bn_vector.h"
+#include "bn_algorithm.h"
+#include "bn_regular_bg_ptr.h"
+#include "bn_regular_bg_item.h"
+#include "bn_regular_bg_map_ptr.h"
+
+#include "copy_list.h"
+#include "vram_budget.h"
+#include "strip_map.h"
+#include "tile_flips.h"
+#include "strip_layout.h"
+#include "code_placement.h"
+
+// Copies a region of a regular_bg_item into a column-major, double-buffered 8bpp tile layout
+// and moves each strip vertically with a single copy per strip and frame.
+// The offsets can come from any provider: a function, a table or a simulation.
+// With a single buffer, each update redraws the moved strips from the item in place instead,
+// which takes half the VRAM but twice the copy work, and the strips can tear if it isn't done in VBlank
+class strip_displacement_bg
+{
+
+public:
+    static constexpr int max_strips = 32;
+
+    // Strips with more lines different from the line above them are copied whole instead of sparsely.
+    // Each line change takes a copy command, and the commands of a strip must fit in a copy list
+    static constexpr int max_line_changes = 24;
+    static_assert(max_line_changes + 2 <= copy_list::max_size);
+
+    // The strips start at the given displacements, or at zero if they aren't provided
+    [[nodiscard]] static strip_displacement_bg create(const bn::regular_bg_item& item, const strip_layout& layout,
+                                                      const int8_t* displacements = nullptr, int buffers = 2)
+    {
+        return _create(item, layout, displacements, buffers, nullptr, false);
+    }
+
+    // Same, but the maps are generated at compile time and copied instead of filled cell by cell
+    template<strip_layout Layout>
+    [[nodiscard]] static strip_displacement_bg create(const bn::regular_bg_item& item,
+                                                      const int8_t* displacements = nullptr, int buffers = 2)
+    {
+        const strip_map::cells_type* map_cells[2] = {
+            &strip_map::cells<Layout, 0>, &strip_map::cells<Layout, 1>
+        };
+
+        return _create(item, Layout, displacements, buffers, map_cells, false);
+    }
+
+    #ifdef BENCHMARK
+        // Startup as it was before only the padding lines were cleared: the maps are filled cell by cell,
+        // every allocated tile is cleared and the item is drawn into both buffers (two buffers, no displacements)
+        [[nodiscard]] static strip_displacement_bg create_legacy(const bn::regular_bg_item& item,
+                                                                 const strip_layout& layout);
+    #endif
+
+    [[nodiscard]] const bn::regular_bg_item& item() const
+    {
+        return *_item;
+    }
+
+    void set_item(const bn::regular_bg_item& item)
+    {
+        _item = &item;
+        _item_flipped = tile_flips::any(item, _layout);
+        _revealed_item = nullptr;
+        _transfer();
+    }
+
+    // Switches to the given item strips_per_update strips per update, from left to right,
+    // instead of transferring it all at once (two buffers only).
+    // Both items are displayed at the same time, so they must share the palette
+    void reveal_item(const bn::regular_bg_item& item, int strips_per_update);
+
+    [[nodiscard]] bool revealing() const
+    {
+        return _revealed_item != nullptr;
+    }
+
+    [[nodiscard]] const strip_layout& layout() const
+    {
+        return _layout;
+    }
+
+    [[nodiscard]] const bn::regular_bg_ptr& bg() const
+    {
+        return _bg;
+    }
+
+    [[nodiscard]] bn::regular_bg_ptr& bg()
+    {
+        return _bg;
+    }
+
+    // When DMA is enabled, the copy commands are executed with DMA instead of the CPU
+    [[nodiscard]] bool dma_enabled() const
+    {
+        return _dma_enabled;
+    }
+
+    void set_dma_enabled(bool dma_enabled)
+    {
+        _dma_enabled = dma_enabled;
+    }
+
+    // When sparse copies are enabled, only the lines of each strip which change between its position in the
+    // destination buffer and the new one are copied, instead of the whole strip (two buffers only).
+    // Strips with too many different lines, like gradients, are still copied whole
+    [[nodiscard]] bool sparse_enabled() const
+    {
+        return _sparse_enabled;
+    }
+
+    void set_sparse_enabled(bool sparse_enabled)
+    {
+        _sparse_enabled = sparse_enabled;
+    }
+
+    // Strips of the current item with few enough different lines to be copied sparsely (two buffers only)
+    [[nodiscard]] int sparse_strips() const
+    {
+        int result = 0;
+
+        for(int strip = 0, strips = _layout.strips(); strip < strips; ++strip)
+        {
+            result += _line_changes_count[strip] <= max_line_changes;
+        }
+
+        return result;
+    }
+
+    // Number of tile buffers (1 or 2)
+    [[nodiscard]] int buffers() const
+    {
+        return _maps.size();
+    }
+
+    // Background VRAM and palette colors taken
+    [[nodiscard]] vram_budget::usage vram_usage() const
+    {
+        return vram_budget::strip_usage(_layout, buffers(), _item->palette_item().colors_ref().size());
+    }
+
+    // Strips moved by the last update or replay, which can be more than the requested ones
+    [[nodiscard]] int updated_strips() const
+    {
+        return _updated_strips;
+    }
+
+    // Bytes written by the copy commands of the last update or replay
+    [[nodiscard]] int copied_bytes() const
+    {
+        return _copied_bytes;
+    }
+
+    // Index (0 or 1) of the buffer being displayed
+    [[nodiscard]] int displayed_buffer() const
+    {
+        return _displayed_buffer;
+    }
+
+    // Current displacement of each strip of the displayed buffer
+    [[nodiscard]] const int8_t* displacements() const
+    {
+        return _displacements[_displayed_buffer];
+    }
+
+    // Moves the strips in [first_strip, last_strip) towards offset_provider(strip) pixels,
+    // as far as max_delta and max_total_displacement allow. The result is displayed only when the last strip
+    // is reached, so an update can be split in several calls, each one starting where the previous one stopped.
+    // Every strip is updated instead while revealing an item or when the back buffer is outdated
+    // (see updated_strips()). Returns true if every updated strip has reached its offset
+    template<typename OffsetProvider>
+    STRIP_UPDATE_CODE bool update(const OffsetProvider& offset_provider, int first_strip = 0,
+                                  int last_strip = max_strips)
+    {
+        // The destination buffer must have every strip of the current item to only copy what changes
+        bool sparse = _sparse_enabled && ! _back_buffer_outdated && ! _revealed_item;
+
+        int strips = _layout.strips();
+
+        // The revealed strips are drawn into the displayed buffer and copied to the other one,
+        // so no strip can be skipped until both buffers have them
+        if(_revealed_item)
+        {
+            _reveal_strips();
+            first_strip = 0;
+            last_strip = strips;
+        }
+
+        // A buffer which hasn't got the current item can't skip any strip
+        if(_back_buffer_outdated)
+        {
+            first_strip = 0;
+            last_strip = strips;
+        }
+
+        last_strip = bn::min(last_strip, strips);
+        _updated_strips = last_strip - first_strip;
+
+        int src = _displayed_buffer;
+        bool single_buffer = buffers() == 1;
+        const int8_t* src_displacements = _displacements[src];
+        int8_t* dst_displacements = _displacements[single_buffer ? src : src ^ 1];
+        const bn::tile* src_tiles_ptr = _buffer_tiles(src);
+        bn::tile* dst_tiles_ptr = _buffer_tiles(src ^ 1);
+        int max_disp = _layout.max_total_displacement();
+        bool offsets_reached = true;
+        copy_list copies;
+
+        for(int strip = first_strip; strip < last_strip; ++strip)
+        {
+            int disp = src_displacements[strip];
+            int old_dst_disp = dst_displacements[strip];
+            int target_disp = offset_provider(strip);
+            int d_disp = bn::clamp(bn::clamp(target_disp, -max_disp, max_disp) - disp,
+                                   -strip_layout::max_delta, strip_layout::max_delta);
+            dst_displacements[strip] = int8_t(disp + d_disp);
+            offsets_reached &= disp + d_disp == target_disp;
+
+            if(single_buffer)
+            {
+                _redraw_strip(strip, disp, d_disp, copies);
+            }
+            else
+            {
+                _push_strip(src_tiles_ptr, dst_tiles_ptr, strip, disp, d_disp, old_dst_disp, sparse, copies);
+            }
+        }
+
+        if(last_strip < strips)
+        {
+            // The rest of the strips are updated by the next call, which displays the result
+            _execute(copies);
+            _copied_bytes = 4 * copies.words();
+        }
+        else
+        {
+            _present(copies);
+        }
+
+        return offsets_reached;
+    }
+
+    // Moves every strip by the given deltas, which must keep them inside their padding (two buffers only)
+    STRIP_UPDATE_CODE void replay(const int8_t* deltas);
+
+private:
+    const bn::regular_bg_item* _item;
+    strip_layout _layout;
+    bn::regular_bg_ptr _bg;
+    bn::vector<bn::regular_bg_map_ptr, 2> _maps;
+    int _displayed_buffer = 0;
+    int _updated_strips = 0;
+    int _copied_bytes = 0;
+    bool _back_buffer_outdated = true;
+    bool _dma_enabled = false;
+    bool _sparse_enabled = true;
+
+    // If the items have flipped tiles, which need the flip-aware copy routines
+    bool _item_flipped = false;
+    bool _revealed_item_flipped = false;
+
+    // Item being revealed, strips already revealed and strips revealed per update
+    const bn::regular_bg_item* _revealed_item = nullptr;
+    int _revealed_strips = 0;
+    int _reveal_speed = 0;
+
+    // Current displacement of each strip in each buffer
+    int8_t _displacements[2][max_strips] = {};
+
+    // Lines of each strip of the current item which are different from the line above them.
+    // A count greater than max_line_changes means the strip has too many to be copied sparsely
+    int16_t _line_changes[max_strips][max_line_changes] = {};
+    int8_t _line_changes_count[max_strips] = {};
+
+    [[nodiscard]] static strip_displacement_bg _create(
+            const bn::regular_bg_item& item, const strip_layout& layout, const int8_t* displacements, int buffers,
+            const strip_map::cells_type* const* map_cells, bool clear_all_tiles);
+
+    strip_displacement_bg(const bn::regular_bg_item& item, const strip_layout& layout, bn::regular_bg_ptr&& bg,
+                          bn::vector<bn::regular_bg_map_ptr, 2>&& maps, const int8_t* displacements);
+
+    // First tile of the given buffer (in 4bpp tiles, since that's what bn::tile represents)
+    [[nodiscard]] bn::tile* _buffer_tiles(int buffer) const;
+
+    // Queues the copy of a strip from the source buffer to the destination one, moved by d_disp pixels
+    void _push_strip(const bn::tile* src_tiles_ptr, bn::tile* dst_tiles_ptr, int strip, int disp, int d_disp,
+                     int old_dst_disp, bool sparse, copy_list& copies)
+    {
+        // The whole tiles are moved in the map of the destination buffer, and the rest in its tiles
+        if(_layout.max_tile_offset)
+        {
+            int new_tile_offset = _layout.tile_offset(disp + d_disp);
+            int old_tile_offset = _layout.tile_offset(old_dst_disp);
+
+            if(new_tile_offset != old_tile_offset)
+            {
+                _set_tile_offset(_displayed_buffer ^ 1, strip, old_tile_offset, new_tile_offset);
+            }
+
+            int line_disp = _layout.line_offset(disp);
+            d_disp = _layout.line_offset(disp + d_disp) - line_disp;
+            old_dst_disp = _layout.line_offset(old_dst_disp);
+            disp = line_disp;
+        }
+
+        // Only the lines of the strip are copied, and the ones it leaves in its padding are cleared.
+        // The lines between the columns of a strip are blank, so the whole strip is copied at once.
+        // uint64_t is 8 bytes, exactly the size of one tile row
+        int column_lines = 8 * _layout.column_stride();
+        int strip_lines = column_lines * _layout.strip_width - 16;
+        int first_line = column_lines * _layout.strip_width * strip + 8;
+        int new_disp = disp + d_disp;
+        const uint64_t* src_lines_ptr = reinterpret_cast<const uint64_t*>(src_tiles_ptr) + first_line;
+        uint64_t* dst_lines_ptr = reinterpret_cast<uint64_t*>(dst_tiles_ptr) + first_line;
+
+        if(sparse && _line_changes_count[strip] <= max_line_changes)
+        {
+            _push_sparse_strip(src_lines_ptr + disp, dst_lines_ptr, strip, strip_lines, new_disp, old_dst_disp,
+                               copies);
+            return;
+        }
+
+        if(copies.size() > copy_list::max_size - 2)
+        {
+            _execute(copies);
+        }
+
+        copies.push_back(src_lines_ptr + disp, dst_lines_ptr + new_disp, 2 * strip_lines);
+
+        // Clear the lines the strip had in the destination buffer and doesn't cover anymore
+        if(new_disp > old_dst_disp)
+        {
+            copies.push_back(blank_tile_8bpp, dst_lines_ptr + old_dst_disp, 2 * (new_disp - old_dst_disp));
+        }
+        else if(new_disp < old_dst_disp)
+        {
+            copies.push_back(blank_tile_8bpp, dst_lines_ptr + new_disp + strip_lines,
+                             2 * (old_dst_disp - new_disp));
+        }
+    }
+
+    // Queues the copies of the lines of a strip which change when it's moved from old_disp to new_disp.
+    // strip_lines_ptr points to the first line of the strip in the source buffer,
+    // and dst_lines_ptr to the line of the destination buffer where it starts without displacement
+    void _push_sparse_strip(const uint64_t* strip_lines_ptr, uint64_t* dst_lines_ptr, int strip, int strip_lines,
+                            int new_disp, int old_disp, copy_list& copies) const
+    {
+        int lines = bn::abs(new_disp - old_disp);
+
+        if(! lines)
+        {
+            return;
+        }
+
+        if(copies.size() > copy_list::max_size - max_line_changes - 2)
+        {
+            _execute(copies);
+        }
+
+        // At the edges, the lines which enter the strip are copied and the ones which leave it are cleared
+        int words = 2 * lines;
+
+        if(new_disp < old_disp)
+        {
+            copies.push_back(strip_lines_ptr, dst_lines_ptr + new_disp, words);
+            copies.push_back(blank_tile_8bpp, dst_lines_ptr + new_disp + strip_lines, words);
+        }
+        else
+        {
+            copies.push_back(blank_tile_8bpp, dst_lines_ptr + old_disp, words);
+            copies.push_back(strip_lines_ptr + strip_lines - lines, dst_lines_ptr + old_disp + strip_lines, words);
+        }
+
+        // Inside, a line only changes if there's a line change of the strip between its old and new positions
+        int low_disp = bn::min(new_disp, old_disp);
+        int high_disp = bn::max(new_disp, old_disp);
+        const int16_t* line_changes = _line_changes[strip];
+
+        for(int index = 0, count = _line_changes_count[strip]; index < count; ++index)
+        {
+            int line_change = line_changes[index];
+            int first_line = bn::max(line_change + low_disp, new_disp);
+            int last_line = bn::min(line_change + high_disp, new_disp + strip_lines);
+            copies.push_back(strip_lines_ptr + (first_line - new_disp), dst_lines_ptr + first_line,
+                             2 * (last_line - first_line));
+        }
+    }
+
+    // Finds the line changes of each strip of the displayed buffer
+    void _find_line_changes();
+
+    // Moves the map cells of a strip of the given buffer from one tile offset to another
+    void _set_tile_offset(int buffer, int strip, int old_tile_offset, int new_tile_offset);
+
+    // Draws a strip of the given buffer from the given item at the given displacement (only its line offset)
+    void _draw_strip(const bn::regular_bg_item& item, bool flipped, int buffer, int strip, int disp) const;
+
+    // Draws a strip of the displayed buffer from the item, moved d_disp pixels from disp,
+    // and queues the clear of the lines it leaves behind
+    void _redraw_strip(int strip, int disp, int d_disp, copy_list& copies);
+
+    // Draws the next strips of the revealed item over the displayed buffer
+    void _reveal_strips();
+
+    // Executes the copies and displays the buffer they were written to
+    void _present(copy_list& copies);
+
+    // Transfer the item's data to the graphics
+    void _transfer();
+
+    void _execute(copy_list& copies) const
+    {
+        if(_dma_enabled)
+        {
+            copies.execute_dma();
+        }
+        else
+        {
+            copies.execute();
+        }
+    }
+};
+
+#endif
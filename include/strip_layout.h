@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------------
+// strip_layout.h
+//--------------------------------------------------------------------------------
+// Geometry of a background region split in vertical strips
+//--------------------------------------------------------------------------------
+
+#ifndef STRIP_LAYOUT_H
+#define STRIP_LAYOUT_H
+
+// Each tile column of the region is stored contiguously in VRAM with a padding tile above and below,
+// so moving it vertically by some pixels is just copying it a few 8-byte rows up or down.
+// Each column has its own padding tiles: a tile shared by two columns would be displayed below one
+// and above the other, so the lines a column pushes into it would show next to its neighbour.
+// Strips can also be moved whole tiles by rewriting their map cells, so only the rest is copied in their tiles
+struct strip_layout
+{
+    // A strip can move at most max_delta pixels per frame, and its displacement plus
+    // that delta must fit in the padding tile placed above and below it
+    static constexpr int max_delta = 2;
+    static constexpr int max_displacement = 8 - max_delta;
+
+    int x;                  // Region position in the background map, in tiles
+    int y;
+    int width;              // Region size, in tiles
+    int height;
+    int strip_width = 1;    // Tile columns moved together
+    int max_tile_offset = 0;    // Whole tiles a strip can be moved up or down with its map cells
+
+    // Highest displacement of a strip, in pixels
+    [[nodiscard]] constexpr int max_total_displacement() const
+    {
+        return 8 * max_tile_offset + max_displacement;
+    }
+
+    // Whole tiles of the given displacement applied with the map cells: the nearest to it
+    [[nodiscard]] constexpr int tile_offset(int displacement) const
+    {
+        int offset = (displacement + max_displacement) >> 3;
+        return offset < -max_tile_offset ? -max_tile_offset : offset > max_tile_offset ? max_tile_offset : offset;
+    }
+
+    // Pixels of the given displacement applied by copying the tiles (from -max_displacement to max_displacement)
+    [[nodiscard]] constexpr int line_offset(int displacement) const
+    {
+        return displacement - 8 * tile_offset(displacement);
+    }
+
+    [[nodiscard]] constexpr int strips() const
+    {
+        return width / strip_width;
+    }
+
+    // Tiles from the start of a column to the start of the next one (the column and its two padding tiles)
+    [[nodiscard]] constexpr int column_stride() const
+    {
+        return height + 2;
+    }
+
+    // 8bpp tiles of each buffer
+    [[nodiscard]] constexpr int buffer_tiles() const
+    {
+        return width * column_stride();
+    }
+
+    // 8bpp tiles allocated: the buffers and a blank tile for the rest of the map
+    [[nodiscard]] constexpr int allocated_tiles(int buffers = 2) const
+    {
+        return buffers * buffer_tiles() + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+//--------------------------------------------------------------------------------
+// strip_map.h
+//--------------------------------------------------------------------------------
+// Background maps of a strip_layout, generated at compile time
+//--------------------------------------------------------------------------------
+
+#ifndef STRIP_MAP_H
+#define STRIP_MAP_H
+
+#include "bn_array.h"
+#include "bn_regular_bg_map_cell.h"
+
+#include "strip_layout.h"
+
+namespace strip_map
+{
+    // Maps are 32x32 cells
+    constexpr int columns = 32;
+    constexpr int rows = 32;
+    constexpr int cells_count = columns * rows;
+
+    using cells_type = bn::array<bn::regular_bg_map_cell, cells_count>;
+
+    // Cell of the map of the given buffer at the given map position, with the column moved tile_offset tiles down:
+    // the tiles of each column go from its top padding tile to its bottom one, and tile 0 is blank
+    [[nodiscard]] constexpr bn::regular_bg_map_cell cell(const strip_layout& layout, int buffer, int map_x, int map_y,
+                                                         int tile_offset = 0)
+    {
+        int x = map_x - layout.x;
+        int y = map_y - tile_offset - layout.y + 1;
+
+        if(x < 0 || x >= layout.width || y < 0 || y >= layout.height + 2)
+        {
+            return 0;
+        }
+
+        return bn::regular_bg_map_cell(buffer * layout.buffer_tiles() + layout.column_stride() * x + y + 1);
+    }
+
+    template<strip_layout Layout, int Buffer>
+    [[nodiscard]] constexpr cells_type generate()
+    {
+        static_assert(Layout.x >= 0 && Layout.x + Layout.width <= columns, "Invalid layout x");
+        static_assert(Layout.y - Layout.max_tile_offset >= 1 &&
+                      Layout.y + Layout.height + Layout.max_tile_offset + 1 <= rows, "Invalid layout y");
+        static_assert(Layout.allocated_tiles() <= 1024, "Too many tiles");
+
+        cells_type result = {};
+
+        for(int map_y = 0; map_y < rows; ++map_y)
+        {
+            for(int map_x = 0; map_x < columns; ++map_x)
+            {
+                result[columns * map_y + map_x] = cell(Layout, Buffer, map_x, map_y);
+            }
+        }
+
+        return result;
+    }
+
+    // Map of the given buffer of the given layout, stored in ROM and word aligned for fast copies
+    template<strip_layout Layout, int Buffer>
+    alignas(4) inline constexpr cells_type cells = generate<Layout, Buffer>();
+
+    // Checks with a 2x3 region at (1, 1): each column takes 5 tiles, and each buffer 10
+    namespace check
+    {
+        constexpr strip_layout layout = { 1, 1, 2, 3 };
+        constexpr const cells_type& first = cells<layout, 0>;
+        constexpr const cells_type& second = cells<layout, 1>;
+
+        static_assert(first[0] == 0 && first[columns * 5 + 1] == 0 && first[columns + 3] == 0, "Blank outside");
+        static_assert(first[1] == 1 && first[columns * 4 + 1] == 5, "First column from padding to padding");
+        static_assert(first[2] == 6 && first[columns * 4 + 2] == 10, "Padding tiles of each column");
+        static_assert(second[1] == 11 && second[columns * 4 + 2] == 20, "Second buffer after the first");
+        static_assert(cell(layout, 0, 1, 1, 1) == 1 && cell(layout, 0, 1, 5, 1) == 5 && cell(layout, 0, 1, 0, 1) == 0,
+                      "Tile offsets move the column down");
+    }
+}
+
+#endif
@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------------
+// telemetry.h
+//--------------------------------------------------------------------------------
+// Per-frame stats of the flag effect, logged in batches
+//--------------------------------------------------------------------------------
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "bn_common.h"
+#include "bn_timer.h"
+
+#include "cpu_cycles.h"
+
+// Records are stored in a ring buffer in EWRAM while the flag is updated, and they're only logged
+// when flush() is called, outside the hot path. Logging a record turns it into a line of numbers
+// separated by spaces, so long runs can be parsed offline.
+// It's built with USERFLAGS += -DFLAG_TELEMETRY (and needs -DBN_CFG_LOG); otherwise everything is a no-op
+namespace telemetry
+{
+    #ifdef FLAG_TELEMETRY
+        constexpr bool enabled = true;
+    #else
+        constexpr bool enabled = false;
+    #endif
+
+    // Records stored before they're dropped, and records logged at once
+    constexpr int capacity = 64;
+    constexpr int batch_size = 32;
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(batch_size <= capacity);
+
+    struct record
+    {
+        int frame;
+        int simulation_cycles;      // Cloth simulation steps
+        int strips_cycles;          // Displacement computation and copies
+        int copied_bytes;           // Bytes written to VRAM by the copy commands
+        int16_t columns_updated;
+        uint8_t quality_level;      // adaptive_quality::level
+        bool crossfading;
+    };
+
+    // Measures the CPU cycles taken by each phase of an update
+    class stopwatch
+    {
+
+    public:
+        // Returns the CPU cycles elapsed since the stopwatch was created or the last lap, and starts a new lap
+        [[nodiscard]] int lap()
+        {
+            #ifdef FLAG_TELEMETRY
+                int ticks = _timer.elapsed_ticks();
+                _timer.restart();
+                return cpu_cycles::from_ticks(ticks);
+            #else
+                return 0;
+            #endif
+        }
+
+    #ifdef FLAG_TELEMETRY
+        private:
+            bn::timer _timer;
+    #endif
+    };
+
+    // Stores a record, overwriting the oldest one if the buffer is full
+    void push(const record& value);
+
+    // Last record pushed
+    [[nodiscard]] const record& last();
+
+    // Records stored and not logged yet
+    [[nodiscard]] int pending();
+
+    // Logs the stored records and the ones dropped since the last flush
+    void flush();
+
+    // Logs the stored records only when there's a whole batch of them
+    inline void flush_batch()
+    {
+        if constexpr(enabled)
+        {
+            if(pending() >= batch_size)
+            {
+                flush();
+            }
+        }
+    }
+}
+
+#endif
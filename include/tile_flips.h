@@ -0,0 +1,21 @@
+//--------------------------------------------------------------------------------
+// tile_flips.h
+//--------------------------------------------------------------------------------
+// Detection of flipped tiles in background items
+//--------------------------------------------------------------------------------
+
+#ifndef TILE_FLIPS_H
+#define TILE_FLIPS_H
+
+#include "bn_regular_bg_item.h"
+
+#include "strip_layout.h"
+
+namespace tile_flips
+{
+    // Returns true if any map cell of the given region of the item is flipped horizontally or vertically.
+    // Items exported with flipped_tiles_reduction can have them, and they need the flip-aware copy routines
+    [[nodiscard]] bool any(const bn::regular_bg_item& item, const strip_layout& layout);
+}
+
+#endif
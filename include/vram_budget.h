@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------------
+// vram_budget.h
+//--------------------------------------------------------------------------------
+// Background VRAM and palette accounting
+//--------------------------------------------------------------------------------
+
+#ifndef VRAM_BUDGET_H
+#define VRAM_BUDGET_H
+
+#include "strip_layout.h"
+
+namespace vram_budget
+{
+    // Background VRAM holds both tiles and maps. The colors are in the palette RAM
+    constexpr int bg_vram_bytes = 64 * 1024;
+    constexpr int bg_palette_colors = 256;
+
+    // Bytes of a 32x32 regular background map
+    constexpr int map_bytes = 32 * 32 * 2;
+
+    struct usage
+    {
+        int tiles_bytes = 0;
+        int maps_bytes = 0;
+        int palette_colors = 0;
+
+        [[nodiscard]] constexpr int vram_bytes() const
+        {
+            return tiles_bytes + maps_bytes;
+        }
+
+        [[nodiscard]] constexpr int free_vram_bytes() const
+        {
+            return bg_vram_bytes - vram_bytes();
+        }
+
+        [[nodiscard]] constexpr int free_palette_colors() const
+        {
+            return bg_palette_colors - palette_colors;
+        }
+
+    };
+
+    // What a strip_displacement_bg with the given layout, buffers and palette colors takes
+    // (8bpp tiles are 64 bytes, and each buffer has its own map)
+    [[nodiscard]] constexpr usage strip_usage(const strip_layout& layout, int buffers, int palette_colors)
+    {
+        return { 64 * layout.allocated_tiles(buffers), buffers * map_bytes, palette_colors };
+    }
+
+    // What every background takes right now, according to butano's managers
+    [[nodiscard]] usage current();
+
+    // Logs the given usage with its free VRAM and colors
+    void log(const char* name, const usage& usage);
+}
+
+#endif
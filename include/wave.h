@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------
+// wave.h
+//--------------------------------------------------------------------------------
+// Precomputed sine wave displacements
+//--------------------------------------------------------------------------------
+
+#ifndef WAVE_H
+#define WAVE_H
+
+#include "bn_common.h"
+#include "flag_data.h"
+
+namespace wave
+{
+    constexpr int period = data::wave_horizontal_period;
+
+    // Displacement of each phase of the period
+    extern int8_t displacements[period];
+
+    // Delta of each flag column between consecutive frames for one full period.
+    // Row f moves a column from frame f to frame f + 1
+    extern int8_t schedule[period][data::flag_width_tiles];
+
+    // Fills the displacements table; it's cheap, so it can be called more than once
+    void init();
+
+    // Fills the schedule from the displacements table, which must be filled first
+    void init_schedule();
+
+    // Get the waving flag displacement based on the position and time.
+    // Since the wave only depends on x - t, jumping several frames ahead costs the same as jumping one
+    [[nodiscard]] inline int displacement(int x, int t)
+    {
+        return displacements[(x - t) & (period - 1)];
+    }
+
+    // Get the delta of a flag column when moving from frame t to frame t + 1
+    [[nodiscard]] inline int scheduled_delta(int column, int t)
+    {
+        return schedule[t & (period - 1)][column];
+    }
+}
+
+#endif
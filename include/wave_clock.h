@@ -0,0 +1,36 @@
+//--------------------------------------------------------------------------------
+// wave_clock.h
+//--------------------------------------------------------------------------------
+// Frame counter driven by a hardware timer
+//--------------------------------------------------------------------------------
+
+#ifndef WAVE_CLOCK_H
+#define WAVE_CLOCK_H
+
+#include "bn_timer.h"
+#include "bn_timers.h"
+
+// Counts the frames elapsed between updates, so animations keep their speed when frames are dropped
+class wave_clock
+{
+
+public:
+    // Returns the frames elapsed since the last call
+    [[nodiscard]] int update()
+    {
+        int ticks = _timer.elapsed_ticks() + _remainder_ticks;
+        _timer.restart();
+
+        int frames = ticks / bn::timers::ticks_per_frame();
+        _remainder_ticks = ticks - frames * bn::timers::ticks_per_frame();
+        return frames;
+    }
+
+private:
+    bn::timer _timer;
+
+    // Starting with half a frame keeps updates called a bit earlier or later than usual from counting 0 or 2 frames
+    int _remainder_ticks = bn::timers::ticks_per_frame() / 2;
+};
+
+#endif
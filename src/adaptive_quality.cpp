@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------------
+// adaptive_quality.cpp
+//--------------------------------------------------------------------------------
+// Chooses how much work the flag can do each frame
+//--------------------------------------------------------------------------------
+
+#include "adaptive_quality.h"
+
+#include "bn_log.h"
+#include "bn_timers.h"
+
+#include "cpu_cycles.h"
+
+const char* adaptive_quality::level_name(level value)
+{
+    switch(value)
+    {
+
+    case level::FULL:
+        return "FULL";
+
+    case level::HALF_RATE:
+        return "HALF_RATE";
+
+    default:
+        return "HOLD";
+    }
+}
+
+adaptive_quality::level adaptive_quality::begin_update()
+{
+    int remaining_cycles = cpu_cycles::remaining_in_frame();
+
+    // More than one frame since the last update means that a VBlank was missed
+    bool frame_dropped = _frame_timer.elapsed_ticks() > bn::timers::ticks_per_frame() * 3 / 2;
+    _frame_timer.restart();
+    _update_timer.restart();
+
+    if(frame_dropped || _level_cycles(_level) > remaining_cycles)
+    {
+        // Degrade one level at a time
+        _headroom_frames = 0;
+
+        if(_level != level::HOLD)
+        {
+            _set_level(level(int(_level) + 1), remaining_cycles);
+        }
+    }
+    else if(_level != level::FULL)
+    {
+        // Restore one level after enough frames where it would have fitted twice
+        if(2 * _level_cycles(level(int(_level) - 1)) <= remaining_cycles)
+        {
+            if(++_headroom_frames == restore_frames)
+            {
+                _headroom_frames = 0;
+                _set_level(level(int(_level) - 1), remaining_cycles);
+            }
+        }
+        else
+        {
+            _headroom_frames = 0;
+        }
+    }
+
+    level work = _level;
+
+    // If this frame is too heavy even for the current level, just keep the displayed one
+    if(_level_cycles(work) > remaining_cycles)
+    {
+        work = level::HOLD;
+    }
+
+    return work;
+}
+
+void adaptive_quality::end_update(int columns_updated, int total_columns)
+{
+    if(columns_updated)
+    {
+        // Smooth the full update estimate to avoid reacting to a single slow frame
+        int cycles = cpu_cycles::from_ticks(_update_timer.elapsed_ticks());
+        int full_update_cycles = cycles * total_columns / columns_updated;
+        _full_update_cycles = (3 * _full_update_cycles + full_update_cycles) / 4;
+    }
+}
+
+int adaptive_quality::_level_cycles(level value) const
+{
+    switch(value)
+    {
+
+    case level::FULL:
+        return _full_update_cycles;
+
+    case level::HALF_RATE:
+        return _full_update_cycles / 2;
+
+    default:
+        return 0;
+    }
+}
+
+void adaptive_quality::_set_level(level value, int remaining_cycles)
+{
+    BN_LOG("adaptive_quality: ", level_name(_level), " -> ", level_name(value),
+           " (remaining cycles: ", remaining_cycles, ", full update cycles: ", _full_update_cycles, ")");
+
+    _level = value;
+}
@@ -0,0 +1,96 @@
+@--------------------------------------------------------------------------------
+@ arm_copy_horizontal_tile_strip.s
+@--------------------------------------------------------------------------------
+@ Provides the implementation of void arm::copy_horizontal_tile_strip_8bpp
+@--------------------------------------------------------------------------------
+
+@ void arm::copy_horizontal_tile_strip_8bpp(void* dest, const void* src,
+@       const uint16_t* map_cells, int num_tiles, int shift);
+@ r0: dest - the tile strip to copy the horizontal tiles to (num_tiles + 1 tiles are written)
+@ r1: src - the pointer to the first tile to be copied
+@ r2: map_cells
+@ r3: num_tiles (must be greater than 0)
+@ [sp]: shift - pixels to move the strip to the right, from 0 to 7
+@
+@ In 8bpp each tile line is 8 bytes (two words) and each byte is a pixel, so moving a line to the right
+@ is a left shift of its words, carrying the bytes that overflow into the next tile of the same line.
+@ Shifts of 4 pixels or more move whole words, so they use a carry of two words instead of one.
+    .section .iwram._ZN3arm31copy_horizontal_tile_strip_8bppEPvPKvPKtii, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm31copy_horizontal_tile_strip_8bppEPvPKvPKtii
+    .type _ZN3arm31copy_horizontal_tile_strip_8bppEPvPKvPKtii STT_FUNC
+_ZN3arm31copy_horizontal_tile_strip_8bppEPvPKvPKtii:
+    push    {r4-r11, lr}            @ Push the necessary registers to stack
+
+    ldr     r12, [sp, #36]          @ Get the shift
+    and     r4, r12, #3             @ r4: bits to shift left inside a word
+    mov     r4, r4, lsl #3
+    rsb     r5, r4, #32             @ r5: bits to shift right the carry (32 gives 0)
+    mov     r6, #0                  @ r6: offset of the current line inside a tile
+    tst     r12, #4                 @ Shifts of 4 pixels or more have their own loop
+    bne     .Lhigh_shift_line
+
+.Llow_shift_line:
+    mov     r7, r2                  @ Start again from the first map cell
+    add     r8, r0, r6              @ and the current line of the first dest tile
+    mov     r9, r3
+    mov     r11, #0                 @ Nothing to carry at the left of the strip
+
+.Llow_shift_tile:
+    ldrh    r12, [r7], #2           @ Get the next tile ID (and add 2 to get the next horizontal tile)
+    add     r12, r1, r12, lsl #6    @ Get the tile address from the tile ID
+    add     r12, r12, r6            @ and the address of the current line
+    ldmia   r12, {r12, lr}          @ Get the line
+    mov     r10, r11, lsr r5        @ Low word: the carry and the start of the low word
+    orr     r10, r10, r12, lsl r4
+    mov     r11, lr                 @ The high word is the next carry
+    mov     lr, lr, lsl r4          @ High word: the rest of the low word and the start of the high word
+    orr     lr, lr, r12, lsr r5
+    stmia   r8, {r10, lr}           @ Store the shifted line
+    add     r8, r8, #64             @ and go to the same line of the next tile
+    subs    r9, r9, #1
+    bne     .Llow_shift_tile
+
+    mov     r10, r11, lsr r5        @ Flush the carry into the extra tile
+    mov     lr, #0
+    stmia   r8, {r10, lr}
+    add     r6, r6, #8              @ Go to the next line
+    cmp     r6, #64
+    bne     .Llow_shift_line
+    b       .Ldone
+
+.Lhigh_shift_line:
+    mov     r7, r2                  @ Start again from the first map cell
+    add     r8, r0, r6              @ and the current line of the first dest tile
+    mov     r9, r3
+    mov     r10, #0                 @ Nothing to carry at the left of the strip
+    mov     r11, #0
+
+.Lhigh_shift_tile:
+    ldrh    r12, [r7], #2           @ Get the next tile ID (and add 2 to get the next horizontal tile)
+    add     r12, r1, r12, lsl #6    @ Get the tile address from the tile ID
+    add     r12, r12, r6            @ and the address of the current line
+    ldmia   r12, {r12, lr}          @ Get the line
+    mov     r10, r10, lsr r5        @ Low word: the two carried words
+    orr     r10, r10, r11, lsl r4
+    mov     r11, r11, lsr r5        @ High word: the high carried word and the start of the low word
+    orr     r11, r11, r12, lsl r4
+    stmia   r8, {r10, r11}          @ Store the shifted line
+    add     r8, r8, #64             @ and go to the same line of the next tile
+    mov     r10, r12                @ The whole line is the next carry
+    mov     r11, lr
+    subs    r9, r9, #1
+    bne     .Lhigh_shift_tile
+
+    mov     r10, r10, lsr r5        @ Flush the carry into the extra tile
+    orr     r10, r10, r11, lsl r4
+    mov     r11, r11, lsr r5
+    stmia   r8, {r10, r11}
+    add     r6, r6, #8              @ Go to the next line
+    cmp     r6, #64
+    bne     .Lhigh_shift_line
+
+.Ldone:
+    pop     {r4-r11, lr}            @ Restore the stack frame
+    bx      lr                      @ and return
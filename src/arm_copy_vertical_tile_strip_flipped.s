@@ -0,0 +1,80 @@
+@--------------------------------------------------------------------------------
+@ arm_copy_vertical_tile_strip_flipped.s
+@--------------------------------------------------------------------------------
+@ Provides the implementation of void arm::copy_vertical_tile_strip_8bpp_flipped
+@--------------------------------------------------------------------------------
+
+@ void arm::copy_vertical_tile_strip_8bpp_flipped(void* dest, const void* src,
+@       const uint16_t* map_cells, int num_tiles);
+@ r0: dest - the tile strip to copy the vertical tiles to
+@ r1: src - the pointer to the first tile to be copied
+@ r2: map_cells
+@ r3: num_tiles
+@
+@ Same as copy_vertical_tile_strip_8bpp, but honouring the flip bits of the map cells
+@ (bit 10: horizontal flip, bit 11: vertical flip). Unflipped tiles are copied with the same two bursts,
+@ and flipped ones a line at a time: a vertical flip reads the lines from the last one,
+@ and a horizontal flip reverses the 8 bytes of each line by byte swapping and exchanging its two words
+    .section .iwram._ZN3arm37copy_vertical_tile_strip_8bpp_flippedEPvPKvPKti, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm37copy_vertical_tile_strip_8bpp_flippedEPvPKvPKti
+    .type _ZN3arm37copy_vertical_tile_strip_8bpp_flippedEPvPKvPKti STT_FUNC
+_ZN3arm37copy_vertical_tile_strip_8bpp_flippedEPvPKvPKti:
+    cmp     r3, #0                  @ Return if there isn't any tiles to copy
+    bxeq    lr
+
+    push    {r4-r11}                @ Push the necessary registers to stack
+
+.Lcopy_tile:
+    ldrh    r12, [r2], #64          @ Get the next map cell (and add 32*2 to get the next vertical tile)
+    tst     r12, #0x0C00            @ Check the flip bits
+    bne     .Lflipped_tile
+    add     r12, r1, r12, lsl #6    @ Get the tile address from the tile ID
+    ldmia   r12!, {r4-r11}          @ Get the first 32 bytes of the tile
+    stmia   r0!, {r4-r11}           @ and transfer them to the storage
+    ldmia   r12, {r4-r11}           @ Get the last 32 bytes of the tile
+    stmia   r0!, {r4-r11}           @ and transfer them as well
+
+.Lnext_tile:
+    subs    r3, r3, #1              @ Subtract one from the counter
+    bne     .Lcopy_tile             @ and return if there are still tiles to copy
+
+    pop     {r4-r11}                @ Restore the stack frame
+    bx      lr                      @ and return
+
+.Lflipped_tile:
+    mov     r11, r12                @ r11: map cell, to check the flips
+    mov     r12, r12, lsl #22       @ Remove the flip bits from the tile ID
+    add     r12, r1, r12, lsr #16   @ and get the tile address (tile ID * 64)
+    mov     r7, #8                  @ r7: bytes from a read line to the next one
+    tst     r11, #0x0800            @ A vertical flip reads from the last line up
+    addne   r12, r12, #56
+    mvnne   r7, #7                  @ (-8)
+    mov     r8, #8                  @ r8: lines left
+    tst     r11, #0x0400
+    bne     .Lhorizontal_flip_line
+
+.Lvertical_flip_line:
+    ldmia   r12, {r4, r5}           @ Get the line
+    add     r12, r12, r7            @ and go to the next one
+    stmia   r0!, {r4, r5}           @ Store it
+    subs    r8, r8, #1
+    bne     .Lvertical_flip_line
+    b       .Lnext_tile
+
+.Lhorizontal_flip_line:
+    ldmia   r12, {r4, r5}           @ Get the line
+    add     r12, r12, r7            @ and go to the next one
+    eor     r6, r5, r5, ror #16     @ r9: the high word byte swapped, which is the new low word
+    bic     r6, r6, #0x00FF0000
+    mov     r9, r5, ror #8
+    eor     r9, r9, r6, lsr #8
+    eor     r6, r4, r4, ror #16     @ r10: the low word byte swapped, which is the new high word
+    bic     r6, r6, #0x00FF0000
+    mov     r10, r4, ror #8
+    eor     r10, r10, r6, lsr #8
+    stmia   r0!, {r9, r10}          @ Store the reversed line
+    subs    r8, r8, #1
+    bne     .Lhorizontal_flip_line
+    b       .Lnext_tile
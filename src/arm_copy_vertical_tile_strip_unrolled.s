@@ -0,0 +1,118 @@
+@--------------------------------------------------------------------------------
+@ arm_copy_vertical_tile_strip_unrolled.s
+@--------------------------------------------------------------------------------
+@ Provides the unrolled variants of void arm::copy_vertical_tile_strip_8bpp
+@--------------------------------------------------------------------------------
+
+@ Every variant alternates two address registers (r12 and lr), so the map cell of the next tile
+@ is loaded while the current one is copied and the ldrh result is never used by the next instruction.
+@ The map cell after the last tile is never read.
+@ Unified syntax is needed for the conditional ldrh (ldrhne instead of ldrneh)
+    .syntax unified
+
+@ Copies the 64 bytes of the tile at the given address to r0, advancing r0
+.macro copy_tile address
+    ldmia   \address!, {r4-r11}     @ Get the first 32 bytes of the tile
+    stmia   r0!, {r4-r11}           @ and transfer them to the storage
+    ldmia   \address, {r4-r11}      @ Get the last 32 bytes of the tile
+    stmia   r0!, {r4-r11}           @ and transfer them as well
+.endm
+
+@ void arm::copy_vertical_tile_strip_8bpp_x2(void* dest, const void* src,
+@       const uint16_t* map_cells, int num_tiles);
+@ r0: dest - the tile strip to copy the vertical tiles to
+@ r1: src - the pointer to the first tile to be copied
+@ r2: map_cells
+@ r3: num_tiles - must be a multiple of 2
+    .section .iwram._ZN3arm32copy_vertical_tile_strip_8bpp_x2EPvPKvPKti, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm32copy_vertical_tile_strip_8bpp_x2EPvPKvPKti
+    .type _ZN3arm32copy_vertical_tile_strip_8bpp_x2EPvPKvPKti STT_FUNC
+_ZN3arm32copy_vertical_tile_strip_8bpp_x2EPvPKvPKti:
+    cmp     r3, #0                  @ Return if there isn't any tiles to copy
+    bxeq    lr
+
+    push    {r4-r11, lr}            @ Push the necessary registers to stack
+    ldrh    r12, [r2], #64          @ Get the first tile ID
+
+.Lcopy_2_tiles:
+    ldrh    lr, [r2], #64           @ Get the second tile ID
+    add     r12, r1, r12, lsl #6    @ Get the first tile address from its ID
+    copy_tile r12
+    subs    r3, r3, #2              @ Subtract both tiles from the counter
+    ldrhne  r12, [r2], #64          @ and get the first tile ID of the next pair, if there's one
+    add     lr, r1, lr, lsl #6      @ Get the second tile address from its ID
+    copy_tile lr
+    bne     .Lcopy_2_tiles          @ ldm/stm don't change the flags, so continue if there are still tiles
+
+    pop     {r4-r11, lr}            @ Restore the stack frame
+    bx      lr                      @ and return
+
+@ void arm::copy_vertical_tile_strip_8bpp_x4(void* dest, const void* src,
+@       const uint16_t* map_cells, int num_tiles);
+@ r0: dest - the tile strip to copy the vertical tiles to
+@ r1: src - the pointer to the first tile to be copied
+@ r2: map_cells
+@ r3: num_tiles - must be a multiple of 4
+    .section .iwram._ZN3arm32copy_vertical_tile_strip_8bpp_x4EPvPKvPKti, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm32copy_vertical_tile_strip_8bpp_x4EPvPKvPKti
+    .type _ZN3arm32copy_vertical_tile_strip_8bpp_x4EPvPKvPKti STT_FUNC
+_ZN3arm32copy_vertical_tile_strip_8bpp_x4EPvPKvPKti:
+    cmp     r3, #0                  @ Return if there isn't any tiles to copy
+    bxeq    lr
+
+    push    {r4-r11, lr}            @ Push the necessary registers to stack
+    ldrh    r12, [r2], #64          @ Get the first tile ID
+
+.Lcopy_4_tiles:
+    ldrh    lr, [r2], #64           @ Get the second tile ID
+    add     r12, r1, r12, lsl #6    @ and copy the first tile
+    copy_tile r12
+    ldrh    r12, [r2], #64          @ Get the third tile ID
+    add     lr, r1, lr, lsl #6      @ and copy the second tile
+    copy_tile lr
+    ldrh    lr, [r2], #64           @ Get the fourth tile ID
+    add     r12, r1, r12, lsl #6    @ and copy the third tile
+    copy_tile r12
+    subs    r3, r3, #4              @ Subtract the four tiles from the counter
+    ldrhne  r12, [r2], #64          @ and get the first tile ID of the next group, if there's one
+    add     lr, r1, lr, lsl #6      @ Copy the fourth tile
+    copy_tile lr
+    bne     .Lcopy_4_tiles          @ and continue if there are still tiles
+
+    pop     {r4-r11, lr}            @ Restore the stack frame
+    bx      lr                      @ and return
+
+@ void arm::copy_vertical_tile_strip_8bpp_16(void* dest, const void* src, const uint16_t* map_cells);
+@ r0: dest - the tile strip to copy the 16 vertical tiles to
+@ r1: src - the pointer to the first tile to be copied
+@ r2: map_cells
+    .section .iwram._ZN3arm32copy_vertical_tile_strip_8bpp_16EPvPKvPKt, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm32copy_vertical_tile_strip_8bpp_16EPvPKvPKt
+    .type _ZN3arm32copy_vertical_tile_strip_8bpp_16EPvPKvPKt STT_FUNC
+_ZN3arm32copy_vertical_tile_strip_8bpp_16EPvPKvPKt:
+    push    {r4-r11, lr}            @ Push the necessary registers to stack
+    ldrh    r12, [r2], #64          @ Get the first tile ID
+
+    .rept 7                         @ Copy the first 14 tiles without any branch
+    ldrh    lr, [r2], #64
+    add     r12, r1, r12, lsl #6
+    copy_tile r12
+    ldrh    r12, [r2], #64
+    add     lr, r1, lr, lsl #6
+    copy_tile lr
+    .endr
+
+    ldrh    lr, [r2], #64           @ Get the last tile ID
+    add     r12, r1, r12, lsl #6    @ and copy the last two tiles
+    copy_tile r12
+    add     lr, r1, lr, lsl #6
+    copy_tile lr
+
+    pop     {r4-r11, lr}            @ Restore the stack frame
+    bx      lr                      @ and return
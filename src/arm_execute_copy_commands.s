@@ -0,0 +1,47 @@
+@--------------------------------------------------------------------------------
+@ arm_execute_copy_commands.s
+@--------------------------------------------------------------------------------
+@ Provides the implementation of void arm::execute_copy_commands
+@--------------------------------------------------------------------------------
+
+@ void arm::execute_copy_commands(const copy_command* commands, int count);
+@ r0: commands - array of { src, dest, words } commands
+@ r1: count
+    .section .iwram._ZN3arm21execute_copy_commandsEPK12copy_commandi, "ax", %progbits
+    .align 2
+    .arm
+    .global _ZN3arm21execute_copy_commandsEPK12copy_commandi
+    .type _ZN3arm21execute_copy_commandsEPK12copy_commandi STT_FUNC
+_ZN3arm21execute_copy_commandsEPK12copy_commandi:
+    cmp     r1, #0                  @ Return if there isn't any command to execute
+    bxeq    lr
+
+    push    {r4-r11}                @ Push the necessary registers to stack
+
+.Lnext_command:
+    ldmia   r0!, {r2, r3, r12}      @ Get the source, the destination and the words of the next command
+    subs    r12, r12, #8            @ Check if there's at least a full burst to copy
+    blt     .Lcopy_remainder
+
+.Lcopy_burst:
+    ldmia   r2!, {r4-r11}           @ Get the next 32 bytes
+    stmia   r3!, {r4-r11}           @ and transfer them to the destination
+    subs    r12, r12, #8            @ Subtract the burst from the counter
+    bge     .Lcopy_burst            @ and continue if there's another full burst
+
+.Lcopy_remainder:
+    adds    r12, r12, #8            @ Get the words left (less than a burst)
+    beq     .Lcommand_done
+
+.Lcopy_word:
+    ldr     r4, [r2], #4            @ Copy them one by one
+    str     r4, [r3], #4
+    subs    r12, r12, #1
+    bne     .Lcopy_word
+
+.Lcommand_done:
+    subs    r1, r1, #1              @ Subtract one from the commands counter
+    bne     .Lnext_command          @ and return if there are still commands to execute
+
+    pop     {r4-r11}                @ Restore the stack frame
+    bx      lr                      @ and return
@@ -0,0 +1,477 @@
+//--------------------------------------------------------------------------------
+// benchmark.cpp
+//--------------------------------------------------------------------------------
+// Benchmark ROM entry point (build with USERFLAGS += -DBENCHMARK)
+//--------------------------------------------------------------------------------
+
+#include "benchmark.h"
+
+#include "bn_core.h"
+#include "bn_log.h"
+#include "bn_timer.h"
+#include "bn_assert.h"
+#include "bn_regular_bg_tiles_ptr.h"
+
+#include "bn_regular_bg_items_br_flag.h"
+#include "bn_regular_bg_items_us_flag.h"
+
+#include "wave.h"
+#include "tile_flips.h"
+#include "arm_functions.h"
+#include "flag_bg.h"
+#include "row_displacement_bg.h"
+#include "grid_displacement_bg.h"
+#include "phase_variant_bg.h"
+#include "cpu_cycles.h"
+#include "code_placement.h"
+#include "vram_budget.h"
+#include "cloth_simulation.h"
+
+namespace
+{
+    constexpr int iterations = 64;
+
+    // Returns the average CPU cycles taken by one call of the given function
+    template<typename Function>
+    [[nodiscard]] int measure(const Function& function)
+    {
+        bn::timer timer;
+
+        for(int iteration = 0; iteration < iterations; ++iteration)
+        {
+            function();
+        }
+
+        return cpu_cycles::from_ticks(timer.elapsed_ticks()) / iterations;
+    }
+
+    // Same as measure(), but calling the function once per frame, as the game does
+    template<typename Function>
+    [[nodiscard]] int measure_per_frame(const Function& function)
+    {
+        int ticks = 0;
+
+        for(int iteration = 0; iteration < iterations; ++iteration)
+        {
+            bn::timer timer;
+            function();
+            ticks += timer.elapsed_ticks();
+            bn::core::update();
+        }
+
+        return cpu_cycles::from_ticks(ticks) / iterations;
+    }
+
+    void cloth_benchmark()
+    {
+        cloth_simulation cloth;
+        cloth.set_wind(cloth_simulation::max_wind);
+
+        int cycles = measure([&cloth]{ cloth.update(); });
+        BN_LOG("cloth_simulation::update: ", cycles, " cycles (budget: ", data::cloth_cycle_budget, ")");
+        BN_ASSERT(cycles <= data::cloth_cycle_budget, "Cloth simulation over budget: ", cycles);
+
+        // The flag only moves with the frames elapsed since its last update
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        BN_LOG("flag_bg::update (sine): ", measure_per_frame([&flag]{ flag.update(); }), " cycles");
+
+        flag.set_cloth_enabled(true);
+        BN_LOG("flag_bg::update (cloth): ", measure_per_frame([&flag]{ flag.update(); }), " cycles");
+    }
+
+    void placement_benchmark()
+    {
+        // Build once per variant of code_placement.h and compare the logs
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        int sine_cycles = measure_per_frame([&flag]{ flag.update(); });
+
+        flag.set_schedule_enabled(true);
+
+        int schedule_cycles = measure_per_frame([&flag]{ flag.update(); });
+        flag.set_schedule_enabled(false);
+        flag.set_cloth_enabled(true);
+
+        int cloth_cycles = measure_per_frame([&flag]{ flag.update(); });
+        BN_LOG("Code placement (", code_placement::name, "): ", sine_cycles, " cycles per frame (sine), ",
+               schedule_cycles, " (schedule), ", cloth_cycles, " (cloth)");
+    }
+
+    void tile_strip_benchmark()
+    {
+        // The strips are copied to VRAM, as the flag does. If the flag has flipped tiles,
+        // the variants which aren't flip-aware copy the wrong tiles, but they take the same time
+        constexpr int tiles_count = data::flag_height_tiles;
+        static_assert(tiles_count == 16, "copy_vertical_tile_strip_8bpp_16 copies 16 tiles");
+
+        bn::regular_bg_tiles_ptr tiles = bn::regular_bg_tiles_ptr::allocate(2 * tiles_count, bn::bpp_mode::BPP_8);
+        bn::tile* dest_ptr = tiles.vram()->data();
+        const bn::regular_bg_item& item = bn::regular_bg_items::br_flag;
+        const bn::tile* src_ptr = item.tiles_item().tiles_ref().data();
+        const bn::regular_bg_map_cell* map_ptr = item.map_item().cells_ptr() +
+                (32 * data::flag_offset_y + data::flag_offset_x);
+
+        int loop_cycles = measure([dest_ptr, src_ptr, map_ptr]{
+            arm::copy_vertical_tile_strip_8bpp(dest_ptr, src_ptr, map_ptr, tiles_count);
+        });
+        int x2_cycles = measure([dest_ptr, src_ptr, map_ptr]{
+            arm::copy_vertical_tile_strip_8bpp_x2(dest_ptr, src_ptr, map_ptr, tiles_count);
+        });
+        int x4_cycles = measure([dest_ptr, src_ptr, map_ptr]{
+            arm::copy_vertical_tile_strip_8bpp_x4(dest_ptr, src_ptr, map_ptr, tiles_count);
+        });
+        int full_cycles = measure([dest_ptr, src_ptr, map_ptr]{
+            arm::copy_vertical_tile_strip_8bpp_16(dest_ptr, src_ptr, map_ptr);
+        });
+        int flipped_cycles = measure([dest_ptr, src_ptr, map_ptr]{
+            arm::copy_vertical_tile_strip_8bpp_flipped(dest_ptr, src_ptr, map_ptr, tiles_count);
+        });
+
+        BN_LOG("copy_vertical_tile_strip_8bpp cycles per tile: ", loop_cycles / tiles_count, " (loop), ",
+               x2_cycles / tiles_count, " (x2), ", x4_cycles / tiles_count, " (x4), ",
+               full_cycles / tiles_count, " (16 tiles), ", flipped_cycles / tiles_count, " (flip-aware, ",
+               tile_flips::any(item, data::flag_layout) ? "with" : "without", " flipped tiles)");
+    }
+
+    void copy_list_benchmark()
+    {
+        // Updated once per frame, so the wave moves and the copy lists aren't empty
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        BN_LOG("flag_bg::update (CPU copies): ", measure_per_frame([&flag]{ flag.update(); }), " cycles");
+
+        flag.set_dma_enabled(true);
+        BN_LOG("flag_bg::update (DMA copies): ", measure_per_frame([&flag]{ flag.update(); }), " cycles");
+    }
+
+    void sparse_benchmark()
+    {
+        // The US flag has long runs of equal lines in its stripes, but the Brazilian one doesn't
+        for(const bn::regular_bg_item* item : { &bn::regular_bg_items::us_flag, &bn::regular_bg_items::br_flag })
+        {
+            strip_displacement_bg strips = strip_displacement_bg::create<data::flag_layout>(*item);
+            int frame = 0;
+            auto update = [&strips, &frame]{
+                ++frame;
+                strips.update([frame](int x){ return wave::displacement(8 * x, frame); });
+            };
+
+            strips.set_sparse_enabled(false);
+
+            int whole_cycles = measure_per_frame(update);
+            strips.set_sparse_enabled(true);
+
+            int sparse_cycles = measure_per_frame(update);
+            BN_LOG("strip_displacement_bg::update (", item == &bn::regular_bg_items::us_flag ? "US" : "Brazil",
+                   " flag): ", whole_cycles, " cycles copying whole strips, ", sparse_cycles, " copying sparsely");
+
+            // Strips with more line changes than the limit are copied whole even with sparse copies enabled
+            BN_LOG("    ", strips.sparse_strips(), " of ", data::flag_width_tiles, " strips copied sparsely, ",
+                   data::flag_width_tiles - strips.sparse_strips(), " whole (more than ",
+                   strip_displacement_bg::max_line_changes, " line changes)");
+        }
+    }
+
+    void tile_offsets_benchmark()
+    {
+        // Three times the wave amplitude: the strips are moved whole tiles with the map cells
+        constexpr strip_layout layout = {
+            data::flag_offset_x, data::flag_offset_y, data::flag_width_tiles, data::flag_height_tiles, 1, 1
+        };
+        static_assert(3 * data::wave_vertical_amplitude <= layout.max_total_displacement());
+
+        strip_displacement_bg strips = strip_displacement_bg::create<layout>(bn::regular_bg_items::us_flag);
+        int frame = 0;
+        int cycles = measure_per_frame([&strips, &frame]{
+            ++frame;
+            strips.update([frame](int x){ return 3 * wave::displacement(8 * x, frame); });
+        });
+
+        BN_LOG("strip_displacement_bg::update (", 3 * data::wave_vertical_amplitude, " pixels amplitude, ",
+               layout.max_tile_offset, " tile offset): ", cycles, " cycles");
+    }
+
+    void phase_variants_benchmark()
+    {
+        // The phases of the whole flag don't fit in VRAM, so only the first columns are compared
+        constexpr strip_layout layout = { data::flag_offset_x, data::flag_offset_y, 6, data::flag_height_tiles };
+        static_assert(phase_variant_bg::fits(layout));
+        static_assert(! phase_variant_bg::fits(data::flag_layout));
+
+        int frame = 0;
+        int copy_cycles;
+
+        {
+            strip_displacement_bg strips = strip_displacement_bg::create<layout>(bn::regular_bg_items::br_flag);
+            copy_cycles = measure_per_frame([&strips, &frame]{
+                ++frame;
+                strips.update([frame](int x){ return wave::displacement(8 * x, frame); });
+            });
+        }
+
+        phase_variant_bg phases = phase_variant_bg::create(bn::regular_bg_items::br_flag, layout);
+        int map_cycles = measure_per_frame([&phases, &frame]{
+            ++frame;
+            phases.update([frame](int x){ return wave::displacement(8 * x, frame); });
+        });
+
+        // Phase variants only generate the map cells, which butano uploads in the next VBlank
+        BN_LOG("Updating ", layout.width, " columns: ", copy_cycles, " cycles copying tiles, ", map_cycles,
+               " cycles generating map cells with phase variants (", phase_variant_bg::allocated_tiles(layout),
+               " tiles instead of ", layout.allocated_tiles(), ", plus ", vram_budget::map_bytes,
+               " bytes of map uploaded in VBlank)");
+    }
+
+    void schedule_benchmark()
+    {
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        int computed_cycles = measure_per_frame([&flag]{ flag.update(); });
+
+        flag.set_schedule_enabled(true);
+
+        int replayed_cycles = measure_per_frame([&flag]{ flag.update(); });
+        BN_LOG("flag_bg::update (computed deltas): ", computed_cycles, " cycles");
+        BN_LOG("flag_bg::update (replayed schedule): ", replayed_cycles, " cycles, using ",
+               int(sizeof(wave::schedule)), " bytes of EWRAM");
+
+        // Caching whole frames would make update() a map switch, but they don't fit in BG VRAM
+        constexpr int keyframe_bytes = data::flag_tiles_needed * 64;
+        constexpr int keyframe_cache_bytes = wave::period * keyframe_bytes;
+        constexpr int bg_vram_bytes = 64 * 1024;
+        BN_LOG("Keyframe cache: ", keyframe_cache_bytes, " bytes needed (", keyframe_bytes, " per frame), ",
+               bg_vram_bytes / keyframe_bytes, " frames fit in BG VRAM: ",
+               keyframe_cache_bytes <= bg_vram_bytes ? "available" : "not available");
+    }
+
+    void displacement_layouts_benchmark()
+    {
+        int frame = 0;
+        int vertical_cycles;
+
+        {
+            strip_displacement_bg strips = strip_displacement_bg::create(bn::regular_bg_items::br_flag,
+                                                                         data::flag_layout);
+            vertical_cycles = measure([&strips, &frame]{
+                ++frame;
+                strips.update([frame](int x){ return wave::displacement(8 * x, frame); });
+            });
+        }
+
+        int horizontal_cycles;
+
+        {
+            row_displacement_bg rows = row_displacement_bg::create(bn::regular_bg_items::br_flag,
+                                                                   data::flag_layout);
+            horizontal_cycles = measure([&rows, &frame]{
+                ++frame;
+                rows.update([frame](int y){ return wave::displacement(8 * y, frame); });
+            });
+        }
+
+        // Both passes back to back would need both layouts in VRAM, so their cost is the sum of both updates
+        grid_displacement_bg grid = grid_displacement_bg::create(bn::regular_bg_items::br_flag, data::flag_layout);
+        int grid_cycles = measure([&grid, &frame]{
+            ++frame;
+            grid.update([frame](int x){ return wave::displacement(8 * x, frame); },
+                        [frame](int y){ return wave::displacement(8 * y, frame); });
+        });
+
+        BN_LOG("strip_displacement_bg::update (vertical, ", data::flag_width_tiles, " columns): ",
+               vertical_cycles, " cycles");
+        BN_LOG("row_displacement_bg::update (horizontal, ", data::flag_height_tiles, " rows): ",
+               horizontal_cycles, " cycles");
+        BN_LOG("vertical and horizontal passes back to back: ", vertical_cycles + horizontal_cycles, " cycles");
+        BN_LOG("grid_displacement_bg::update (both in a single pass): ", grid_cycles, " cycles");
+    }
+
+    void wipe_benchmark()
+    {
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+
+        // Switching at once transfers the whole flag in a single update
+        bn::timer timer;
+        flag.set_bg_item(bn::regular_bg_items::us_flag);
+        flag.update();
+
+        int set_bg_item_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        bn::core::update();
+
+        int max_cycles = 0;
+        int updates = 0;
+        flag.wipe_to(bn::regular_bg_items::br_flag);
+
+        while(flag.wiping())
+        {
+            timer.restart();
+            flag.update();
+            max_cycles = bn::max(max_cycles, cpu_cycles::from_ticks(timer.elapsed_ticks()));
+            ++updates;
+            bn::core::update();
+        }
+
+        BN_LOG("flag_bg::set_bg_item and update: ", set_bg_item_cycles, " cycles");
+        BN_LOG("flag_bg wipe (", updates, " updates): ", max_cycles, " cycles at most");
+    }
+
+    void vram_report()
+    {
+        vram_budget::log("flag (compile time)", data::flag_vram_usage);
+        vram_budget::log("crossfade (compile time)", data::crossfade_vram_usage);
+
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        vram_budget::log("flag_bg", flag.vram_usage());
+        vram_budget::log("every background", vram_budget::current());
+
+        flag.crossfade_to(bn::regular_bg_items::us_flag);
+        vram_budget::log("flag_bg while crossfading", flag.vram_usage());
+        vram_budget::log("every background while crossfading", vram_budget::current());
+    }
+
+    void crossfade_benchmark()
+    {
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        int update_cycles = measure_per_frame([&flag]{ flag.update(); });
+
+        // The start and the last update rebuild the backgrounds and transfer whole flags,
+        // so they're reported apart from the updates in between
+        bn::timer timer;
+        flag.crossfade_to(bn::regular_bg_items::us_flag);
+
+        int start_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        int last_cycles = 0;
+        int max_cycles = 0;
+        int total_cycles = 0;
+        int updates = 0;
+
+        while(flag.crossfading())
+        {
+            timer.restart();
+            flag.update();
+
+            int cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+            bn::core::update();
+
+            if(! flag.crossfading())
+            {
+                last_cycles = cycles;
+            }
+            else
+            {
+                max_cycles = bn::max(max_cycles, cycles);
+                total_cycles += cycles;
+                ++updates;
+            }
+        }
+
+        BN_LOG("flag_bg::update: ", update_cycles, " cycles");
+        BN_LOG("flag_bg crossfade (", updates, " updates): ", total_cycles / bn::max(updates, 1),
+               " cycles on average, ", max_cycles, " at most");
+        BN_LOG("flag_bg crossfade spikes: ", start_cycles, " cycles to start, ", last_cycles, " in the last update");
+    }
+
+    void startup_benchmark()
+    {
+        // Each background is destroyed before the next one is created, so they take the same VRAM.
+        // Both paths are timed end to end, from create() to the end of the first update
+        auto first_displacement = [](int x){ return wave::displacement(8 * x, 0); };
+        bn::timer timer;
+        int legacy_create_cycles;
+        int legacy_first_frame_cycles;
+
+        {
+            // Runtime maps, every tile cleared and the item drawn into both buffers
+            strip_displacement_bg strips = strip_displacement_bg::create_legacy(bn::regular_bg_items::br_flag,
+                                                                                data::flag_layout);
+            legacy_create_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+            strips.update(first_displacement);
+            legacy_first_frame_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        }
+
+        bn::core::update();
+
+        int runtime_maps_cycles;
+        timer.restart();
+
+        {
+            strip_displacement_bg strips = strip_displacement_bg::create(bn::regular_bg_items::br_flag,
+                                                                         data::flag_layout);
+            runtime_maps_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        }
+
+        bn::core::update();
+        timer.restart();
+
+        // The back buffer is filled by the first update instead of at creation
+        strip_displacement_bg strips = strip_displacement_bg::create<data::flag_layout>(
+                    bn::regular_bg_items::br_flag);
+        int generated_maps_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        strips.update(first_displacement);
+
+        int first_frame_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+        bn::core::update();
+
+        // Transferring the item again shows the cost of the displayed buffer fill alone
+        timer.restart();
+        strips.set_item(bn::regular_bg_items::br_flag);
+
+        int transfer_cycles = cpu_cycles::from_ticks(timer.elapsed_ticks());
+
+        BN_LOG("strip_displacement_bg::create_legacy: ", legacy_create_cycles, " cycles");
+        BN_LOG("strip_displacement_bg::create (runtime maps): ", runtime_maps_cycles, " cycles");
+        BN_LOG("strip_displacement_bg::create (generated maps): ", generated_maps_cycles, " cycles, ",
+               transfer_cycles, " of them transferring the item");
+        BN_LOG("First update (back buffer fill): ", first_frame_cycles - generated_maps_cycles, " cycles");
+        BN_LOG("Time to first frame: ", legacy_first_frame_cycles, " cycles before, ",
+               first_frame_cycles, " cycles after");
+    }
+
+    void adaptive_quality_benchmark()
+    {
+        flag_bg flag = flag_bg::create(bn::regular_bg_items::br_flag);
+        flag.set_adaptive_enabled(true);
+
+        // Simulate increasingly heavy game frames by waiting for a scanline before updating the flag,
+        // and then light ones again to check that the full quality is restored
+        for(int busy_scanline : { 0, 120, 150, 158, 0 })
+        {
+            for(int frame = 0; frame < 2 * adaptive_quality::restore_frames; ++frame)
+            {
+                if(busy_scanline)
+                {
+                    while(cpu_cycles::current_scanline() >= 160)
+                    {
+                    }
+
+                    while(cpu_cycles::current_scanline() < busy_scanline)
+                    {
+                    }
+                }
+
+                flag.update();
+                bn::core::update();
+            }
+
+            const adaptive_quality& quality = flag.quality();
+            BN_LOG("adaptive_quality (game busy until scanline ", busy_scanline, "): ",
+                   adaptive_quality::level_name(quality.current_level()),
+                   " (full update cycles: ", quality.full_update_cycles(), ")");
+        }
+    }
+}
+
+void benchmark::run()
+{
+    wave::init();
+    cloth_benchmark();
+    placement_benchmark();
+    tile_strip_benchmark();
+    copy_list_benchmark();
+    sparse_benchmark();
+    tile_offsets_benchmark();
+    phase_variants_benchmark();
+    schedule_benchmark();
+    displacement_layouts_benchmark();
+    wipe_benchmark();
+    vram_report();
+    crossfade_benchmark();
+    startup_benchmark();
+    adaptive_quality_benchmark();
+}
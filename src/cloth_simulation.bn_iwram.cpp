@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------
+// cloth_simulation.bn_iwram.cpp
+//--------------------------------------------------------------------------------
+// Cloth simulation step, placed in IWRAM and compiled as ARM
+//--------------------------------------------------------------------------------
+
+#include "cloth_simulation.h"
+
+#include "bn_math.h"
+
+void cloth_simulation::update()
+{
+    int* positions = _nodes[_current];
+    int* previous = _nodes[_current ^ 1];
+    constexpr int limit = data::max_column_displacement << fraction_bits;
+    constexpr int half = 1 << (fraction_bits - 1);
+
+    // The pole end is moved by the wind, and the ghost node makes the free end only feel its left neighbour
+    _phase = (_phase + data::wave_horizontal_multiplier) & 2047;
+
+    int driver = (_wind * bn::lut_sin(_phase).data()) >> (12 - fraction_bits);
+    previous[0] = driver;
+    _displacements[0] = int8_t((driver + half) >> fraction_bits);
+    positions[nodes_count] = positions[nodes_count - 1];
+
+    // Verlet integration; the new positions overwrite the previous ones, which are read only once.
+    // There aren't data dependent branches: clamps compile to conditional moves in ARM mode
+    int left = positions[0];
+    int center = positions[1];
+
+    for(int node = 1; node < nodes_count; ++node)
+    {
+        int right = positions[node + 1];
+        int velocity = ((center - previous[node]) * damping) >> 8;
+        int spring = ((left + right - 2 * center) * stiffness) >> 8;
+        int next = bn::clamp(center + velocity + spring, -limit, limit);
+        previous[node] = next;
+        _displacements[node] = int8_t((next + half) >> fraction_bits);
+        left = center;
+        center = right;
+    }
+
+    _current ^= 1;
+}
@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------------
+// copy_list.cpp
+//--------------------------------------------------------------------------------
+// Batched word copies executed with a single call
+//--------------------------------------------------------------------------------
+
+#include "copy_list.h"
+
+alignas(4) const uint32_t blank_tile_8bpp[16] = {};
+
+namespace
+{
+    volatile uint32_t& dma3_src = *reinterpret_cast<volatile uint32_t*>(0x040000D4);
+    volatile uint32_t& dma3_dest = *reinterpret_cast<volatile uint32_t*>(0x040000D8);
+    volatile uint32_t& dma3_control = *reinterpret_cast<volatile uint32_t*>(0x040000DC);
+
+    // Enable, start immediately, 32-bit units, incrementing addresses
+    constexpr uint32_t dma_words_control = 0x84000000;
+}
+
+void copy_list::execute_dma()
+{
+    // The CPU is halted until each transfer finishes, so the channel is free again for the next command
+    for(int index = 0; index < _size; ++index)
+    {
+        const copy_command& command = _commands[index];
+        BN_ASSERT(command.words > 0 && command.words <= 0x10000, "Invalid words count: ", command.words);
+
+        dma3_src = uint32_t(uintptr_t(command.src));
+        dma3_dest = uint32_t(uintptr_t(command.dest));
+        dma3_control = dma_words_control | uint32_t(command.words & 0xFFFF);
+    }
+
+    _size = 0;
+}
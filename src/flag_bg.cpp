@@ -0,0 +1,298 @@
+//--------------------------------------------------------------------------------
+// flag_bg.cpp
+//--------------------------------------------------------------------------------
+// Waving flag background
+//--------------------------------------------------------------------------------
+
+#include "flag_bg.h"
+
+#include "bn_blending.h"
+#include "bn_algorithm.h"
+
+#include "wave.h"
+
+namespace
+{
+    // Both 8bpp backgrounds use the whole background palette, so they can only be shown together with the same one
+    [[nodiscard]] bool same_palette(const bn::regular_bg_item& a, const bn::regular_bg_item& b)
+    {
+        bn::span<const bn::color> a_colors = a.palette_item().colors_ref();
+        bn::span<const bn::color> b_colors = b.palette_item().colors_ref();
+
+        if(a_colors.size() != b_colors.size())
+        {
+            return false;
+        }
+
+        for(int index = 0, limit = a_colors.size(); index < limit; ++index)
+        {
+            if(a_colors[index] != b_colors[index])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+flag_bg flag_bg::create(const bn::regular_bg_item& bg_item)
+{
+    wave::init();
+
+    // The flag starts at the first frame of the wave
+    int8_t displacements[data::flag_width_tiles];
+
+    for(int x = 0; x < data::flag_width_tiles; x++)
+    {
+        displacements[x] = int8_t(wave::displacement(8 * x, 0));
+    }
+
+    return flag_bg(strip_displacement_bg::create<data::flag_layout>(bg_item, displacements));
+}
+
+vram_budget::usage flag_bg::vram_usage() const
+{
+    vram_budget::usage result = _strips->vram_usage();
+
+    // Both flags share the palette
+    if(_incoming_strips)
+    {
+        vram_budget::usage incoming_usage = _incoming_strips->vram_usage();
+        result.tiles_bytes += incoming_usage.tiles_bytes;
+        result.maps_bytes += incoming_usage.maps_bytes;
+    }
+
+    return result;
+}
+
+void flag_bg::set_cloth_enabled(bool cloth_enabled)
+{
+    // Start the simulation from the current shape of the flag
+    if(cloth_enabled && ! _cloth_enabled)
+    {
+        _cloth.reset(_strips->displacements());
+    }
+
+    _cloth_enabled = cloth_enabled;
+}
+
+void flag_bg::set_adaptive_enabled(bool adaptive_enabled)
+{
+    // Start again with full quality and fresh timers
+    _quality = adaptive_quality();
+    _adaptive_enabled = adaptive_enabled;
+}
+
+void flag_bg::set_schedule_enabled(bool schedule_enabled)
+{
+    if(schedule_enabled && ! _schedule_enabled)
+    {
+        wave::init_schedule();
+    }
+
+    _schedule_enabled = schedule_enabled;
+}
+
+void flag_bg::crossfade_to(const bn::regular_bg_item& bg_item, int frames)
+{
+    BN_ASSERT(frames > 0, "Invalid frames: ", frames);
+    BN_ASSERT(! transitioning(), "Already transitioning");
+    BN_ASSERT(same_palette(bg_item, _strips->item()), "Both flags must share the palette");
+
+    // Two double buffered flags don't fit in VRAM, so during the crossfade both of them
+    // are single buffered and redrawn from their items
+    int8_t displacements[strip_displacement_bg::max_strips];
+    const int8_t* current_displacements = _strips->displacements();
+
+    for(int x = 0; x < data::flag_width_tiles; x++)
+    {
+        displacements[x] = current_displacements[x];
+    }
+
+    const bn::regular_bg_item& outgoing_bg_item = _strips->item();
+    bool dma_enabled = _strips->dma_enabled();
+    _strips.reset();
+    _strips = strip_displacement_bg::create<data::flag_layout>(outgoing_bg_item, displacements, 1);
+    _incoming_strips = strip_displacement_bg::create<data::flag_layout>(bg_item, displacements, 1);
+    _strips->set_dma_enabled(dma_enabled);
+    _incoming_strips->set_dma_enabled(dma_enabled);
+
+    // The outgoing flag is blended over the incoming one
+    _strips->bg().set_blending_enabled(true);
+    _incoming_strips->bg().set_z_order(1);
+    bn::blending::set_transparency_alpha(1);
+
+    _crossfade_frames = frames;
+    _crossfade_frame = 0;
+}
+
+void flag_bg::update()
+{
+    // The wave advances with the elapsed frames, even if the displayed one is kept or some were dropped.
+    // Every column still is copied once: the displacement records of the source buffer
+    // turn a jump of several frames into a single delta per column
+    telemetry::stopwatch stopwatch;
+    int elapsed_frames = bn::min(_clock.update(), data::max_catch_up_frames);
+    _current_frame += elapsed_frames;
+
+    int current_frame = _current_frame;
+    bool cloth_enabled = _cloth_enabled;
+
+    if(cloth_enabled)
+    {
+        for(int frame = 0; frame < elapsed_frames; ++frame)
+        {
+            _cloth.update();
+        }
+    }
+
+    int simulation_cycles = stopwatch.lap();
+
+    // A crossfade redraws both flags every update, so it doesn't change its quality
+    if(_incoming_strips)
+    {
+        _copied_bytes = _update_crossfade(current_frame);
+        _push_telemetry(simulation_cycles, stopwatch.lap(), data::flag_width_tiles, true);
+        return;
+    }
+
+    // Choose which columns to update
+    int first_column = 0;
+    int last_column = data::flag_width_tiles;
+
+    if(_adaptive_enabled)
+    {
+        switch(_quality.begin_update())
+        {
+
+        case adaptive_quality::level::HALF_RATE:
+            // Update half of the columns of the back buffer each time, and display it after the second half
+            if(_back_buffer_half_updated)
+            {
+                first_column = data::flag_width_tiles / 2;
+            }
+            else
+            {
+                last_column = data::flag_width_tiles / 2;
+            }
+            break;
+
+        case adaptive_quality::level::HOLD:
+            _quality.end_update(0, data::flag_width_tiles);
+            _copied_bytes = 0;
+            _push_telemetry(simulation_cycles, stopwatch.lap(), 0, false);
+            return;
+
+        default:
+            break;
+        }
+    }
+
+    // Here, do the "waving flag" displacement
+    int src = _strips->displayed_buffer();
+    int dst = src ^ 1;
+    int previous_frame = current_frame - 1;
+
+    bool replayed = _schedule_enabled && _wave_synced[src] && _buffer_frames[src] == previous_frame &&
+            ! cloth_enabled && first_column == 0 && last_column == data::flag_width_tiles;
+    bool offsets_reached = false;
+
+    if(replayed)
+    {
+        // The source buffer is at the previous frame of the wave, so the deltas can be replayed as they are
+        _strips->replay(wave::schedule[previous_frame & (wave::period - 1)]);
+    }
+    else if(cloth_enabled)
+    {
+        const cloth_simulation& cloth = _cloth;
+        _strips->update([&cloth](int x){ return cloth.displacement(x); }, first_column, last_column);
+    }
+    else
+    {
+        offsets_reached = _strips->update(
+                    [current_frame](int x){ return wave::displacement(8 * x, current_frame); },
+                    first_column, last_column);
+    }
+
+    // The strips update every column while wiping or after a switch, whatever the quality level asked for.
+    // The back buffer is displayed once its last column is updated
+    int updated_columns = _strips->updated_strips();
+    bool every_column = updated_columns == data::flag_width_tiles;
+    _back_buffer_half_updated = _strips->displayed_buffer() == src;
+    _wave_synced[dst] = replayed || (offsets_reached && every_column);
+
+    if(_adaptive_enabled)
+    {
+        _quality.end_update(updated_columns, data::flag_width_tiles);
+    }
+
+    _buffer_frames[dst] = current_frame;
+    _copied_bytes = _strips->copied_bytes();
+    _push_telemetry(simulation_cycles, stopwatch.lap(), updated_columns, false);
+}
+
+flag_bg::flag_bg(strip_displacement_bg&& strips) :
+    _strips(bn::move(strips))
+{
+}
+
+void flag_bg::_push_telemetry(int simulation_cycles, int strips_cycles, int columns_updated, bool crossfading) const
+{
+    if constexpr(telemetry::enabled)
+    {
+        telemetry::push(telemetry::record{ _current_frame, simulation_cycles, strips_cycles, _copied_bytes,
+                                           int16_t(columns_updated), uint8_t(_quality.current_level()),
+                                           crossfading });
+    }
+}
+
+int flag_bg::_update_crossfade(int current_frame)
+{
+    // Both flags get the same offsets, so they move in sync
+    if(_cloth_enabled)
+    {
+        const cloth_simulation& cloth = _cloth;
+        auto offset_provider = [&cloth](int x){ return cloth.displacement(x); };
+        _strips->update(offset_provider);
+        _incoming_strips->update(offset_provider);
+    }
+    else
+    {
+        auto offset_provider = [current_frame](int x){ return wave::displacement(8 * x, current_frame); };
+        _strips->update(offset_provider);
+        _incoming_strips->update(offset_provider);
+    }
+
+    int copied_bytes = _strips->copied_bytes() + _incoming_strips->copied_bytes();
+    ++_crossfade_frame;
+
+    if(_crossfade_frame < _crossfade_frames)
+    {
+        // The alpha is the weight of the outgoing flag
+        bn::blending::set_transparency_alpha(bn::fixed(_crossfade_frames - _crossfade_frame) / _crossfade_frames);
+        return copied_bytes;
+    }
+
+    // Done: keep only the incoming flag, double buffered again (a whole transfer in this update)
+    int8_t displacements[strip_displacement_bg::max_strips];
+    const int8_t* current_displacements = _incoming_strips->displacements();
+
+    for(int x = 0; x < data::flag_width_tiles; x++)
+    {
+        displacements[x] = current_displacements[x];
+    }
+
+    const bn::regular_bg_item& bg_item = _incoming_strips->item();
+    bool dma_enabled = _incoming_strips->dma_enabled();
+    _strips.reset();
+    _incoming_strips.reset();
+    _strips = strip_displacement_bg::create<data::flag_layout>(bg_item, displacements);
+    _strips->set_dma_enabled(dma_enabled);
+    bn::blending::set_transparency_alpha(1);
+
+    // The new buffers don't follow the schedule yet
+    _wave_synced[0] = false;
+    _wave_synced[1] = false;
+    return copied_bytes;
+}
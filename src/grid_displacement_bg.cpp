@@ -0,0 +1,174 @@
+//--------------------------------------------------------------------------------
+// grid_displacement_bg.cpp
+//--------------------------------------------------------------------------------
+// Background whose columns move up and down and whose rows move left and right
+//--------------------------------------------------------------------------------
+
+#include "grid_displacement_bg.h"
+
+#include "bn_span.h"
+#include "bn_memory.h"
+#include "bn_algorithm.h"
+#include "bn_bg_palette_ptr.h"
+#include "bn_regular_bg_tiles_ptr.h"
+
+#include "copy_list.h"
+#include "tile_flips.h"
+#include "arm_functions.h"
+
+grid_displacement_bg grid_displacement_bg::create(const bn::regular_bg_item& item, const strip_layout& layout)
+{
+    BN_ASSERT(layout.x >= 1 && layout.x + layout.width + 1 <= 32, "Invalid layout x: ", layout.x, " - ",
+              layout.width);
+    BN_ASSERT(layout.y >= 1 && layout.y + layout.height + 1 <= 32, "Invalid layout y: ", layout.y, " - ",
+              layout.height);
+    BN_ASSERT(layout.strip_width > 0 && layout.width % layout.strip_width == 0,
+              "Invalid strip width: ", layout.strip_width);
+    BN_ASSERT(2 * _buffer_tiles(layout) + 1 <= 1024, "Too many tiles: ", 2 * _buffer_tiles(layout) + 1);
+    BN_ASSERT(layout.width * _rows(layout) + 2 <= max_source_tiles, "Too many source tiles: ",
+              layout.width * _rows(layout) + 2);
+
+    // Allocate tiles and maps needed for the background
+    // (2 * 4bpp tiles for each 8bpp tile, both buffers and a blank tile for the rest of the map)
+    bn::regular_bg_tiles_ptr tiles = bn::regular_bg_tiles_ptr::allocate(
+                2 * (2 * _buffer_tiles(layout) + 1), bn::bpp_mode::BPP_8);
+    bn::bg_palette_ptr palette = item.palette_item().create_palette();
+
+    // The first tile is displayed outside the region, so it must be blank
+    copy_list copies;
+    copies.push_back(blank_tile_8bpp, tiles.vram()->data(), 16);
+    copies.execute();
+
+    // The padding of the source columns is never written, so it must start blank
+    bn::unique_ptr<source_tiles_type> source_tiles(new source_tiles_type);
+    bn::memory::clear(2 * (layout.width * _rows(layout) + 2), (*source_tiles)[0]);
+
+    // Create the maps
+    bn::vector<bn::regular_bg_map_ptr, 2> maps;
+
+    for(int i : { 0, 1 })
+    {
+        constexpr bn::size map_size(32, 32);
+
+        // Create the map and first fill it blank
+        bn::regular_bg_map_ptr map = bn::regular_bg_map_ptr::allocate(map_size, tiles, palette);
+        bn::span<bn::regular_bg_map_cell> vram = *map.vram();
+        bn::fill(vram.begin(), vram.end(), bn::regular_bg_map_cell());
+
+        // Fill in the map with the proper values, row by row
+        for(int y = 0; y < _rows(layout); y++)
+        {
+            for(int x = 0; x < _row_tiles(layout); x++)
+            {
+                int tile_x = layout.x + x - 1;
+                int tile_y = layout.y + y - 1;
+                int tile_index = _row_tiles(layout) * y + x;
+                int map_cell = i * _buffer_tiles(layout) + tile_index + 1;
+                vram[32 * tile_y + tile_x] = bn::regular_bg_map_cell(map_cell);
+            }
+        }
+
+        maps.push_back(bn::move(map));
+    }
+
+    // Now, create the background
+    bn::regular_bg_ptr bg = bn::regular_bg_ptr::create(0, 0, maps[0]);
+    return grid_displacement_bg(item, layout, bn::move(bg), bn::move(maps), bn::move(source_tiles));
+}
+
+void grid_displacement_bg::set_item(const bn::regular_bg_item& item)
+{
+    _item = &item;
+    _load_item();
+}
+
+grid_displacement_bg::grid_displacement_bg(
+        const bn::regular_bg_item& item, const strip_layout& layout, bn::regular_bg_ptr&& bg,
+        bn::vector<bn::regular_bg_map_ptr, 2>&& maps, bn::unique_ptr<source_tiles_type>&& source_tiles) :
+    _item(&item),
+    _layout(layout),
+    _bg(bn::move(bg)),
+    _maps(bn::move(maps)),
+    _source_tiles(bn::move(source_tiles))
+{
+    _load_item();
+
+    int8_t column_offsets[max_columns] = {};
+    int8_t row_offsets[max_rows] = {};
+    _draw(column_offsets, row_offsets);
+}
+
+void grid_displacement_bg::_load_item()
+{
+    // Get the necessary data
+    const bn::regular_bg_item& item = *_item;
+    const strip_layout& layout = _layout;
+    const bn::tile* item_tiles_ptr = item.tiles_item().tiles_ref().data();
+    const bn::regular_bg_map_cell* item_map_ptr = item.map_item().cells_ptr();
+    int item_map_width = item.map_item().dimensions().width();
+    BN_ASSERT(item_map_width == 32, "Invalid item map width: ", item_map_width);
+    bool flipped = tile_flips::any(item, layout);
+
+    // Copy each column below its top padding tile
+    for(int x = 0; x < layout.width; x++)
+    {
+        bn::tile* column_ptr = _source_tiles->data() + 2 * (_rows(layout) * x + 2);
+        const bn::regular_bg_map_cell* map_ptr = item_map_ptr + (item_map_width * layout.y + layout.x + x);
+        arm::copy_vertical_tile_strip_8bpp_fastest(column_ptr, item_tiles_ptr, map_ptr, layout.height, flipped);
+    }
+
+    // Fix the palette
+    bn::bg_palette_ptr bg_palette = _bg.palette();
+    bg_palette.set_colors(item.palette_item());
+}
+
+void grid_displacement_bg::_draw(const int8_t* column_offsets, const int8_t* row_offsets)
+{
+    const strip_layout& layout = _layout;
+    int rows = _rows(layout);
+    int dst = _displayed_buffer ^ 1;
+
+    // Moving a column down is starting to read it earlier.
+    // uint64_t is 8 bytes, exactly the size of one tile row
+    const void* column_lines[max_columns];
+
+    const bn::tile* source_tiles_ptr = _source_tiles->data();
+
+    for(int x = 0; x < layout.width; x++)
+    {
+        const bn::tile* column_ptr = source_tiles_ptr + 2 * (rows * x + 1);
+        column_lines[x] = reinterpret_cast<const uint64_t*>(column_ptr) - column_offsets[x];
+    }
+
+    // Since we're doing 8-bpp tiles, we need the 2* in this place
+    bn::regular_bg_tiles_ptr bg_tiles = _bg.tiles();
+    bn::tile* dst_tiles_ptr = bg_tiles.vram()->data() + 2 * (_buffer_tiles(layout) * dst + 1);
+    copy_list copies;
+
+    for(int y = 0; y < rows; y++)
+    {
+        // The padding rows move with the flag rows next to them.
+        // Negative offsets are drawn from the left padding tile and the rest from the first flag tile,
+        // so the routine only has to move pixels to the right. The padding tile which isn't drawn is cleared
+        int offset = row_offsets[bn::clamp(y - 1, 0, layout.height - 1)];
+        int first_tile = offset < 0 ? 0 : 1;
+        bn::tile* row_tiles_ptr = dst_tiles_ptr + 2 * _row_tiles(layout) * y;
+        bn::tile* cleared_tile_ptr = row_tiles_ptr + 2 * (first_tile ? 0 : layout.width + 1);
+
+        if(copies.full())
+        {
+            copies.execute();
+        }
+
+        copies.push_back(blank_tile_8bpp, cleared_tile_ptr, 16);
+
+        arm::copy_displaced_tile_strip_8bpp(row_tiles_ptr + 2 * first_tile, column_lines, 64 * y, layout.width,
+                                            offset & 7);
+    }
+
+    copies.execute();
+
+    // And swap the buffers
+    _displayed_buffer = dst;
+    _bg.set_map(_maps[dst]);
+}
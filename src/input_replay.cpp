@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------------
+// input_replay.cpp
+//--------------------------------------------------------------------------------
+// Keypad input of the main loop, live or replayed from a script
+//--------------------------------------------------------------------------------
+
+#include "input_replay.h"
+
+#include "bn_log.h"
+
+#include "input_script.h"
+
+namespace input_replay
+{
+    namespace
+    {
+        constexpr int script_events = sizeof(data::input_script) / sizeof(data::input_script[0]);
+
+        int current_frame = -1;
+        int next_event = 0;
+
+        [[nodiscard]] constexpr bool script_sorted()
+        {
+            for(int index = 1; index < script_events; ++index)
+            {
+                if(data::input_script[index].frame < data::input_script[index - 1].frame)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        static_assert(script_sorted(), "Input script isn't sorted by frame");
+
+        #ifdef INPUT_RECORD
+            struct key_name
+            {
+                bn::keypad::key_type key;
+                const char* name;
+            };
+
+            constexpr key_name key_names[] = {
+                { bn::keypad::key_type::A, "A" },
+                { bn::keypad::key_type::B, "B" },
+                { bn::keypad::key_type::SELECT, "SELECT" },
+                { bn::keypad::key_type::START, "START" },
+                { bn::keypad::key_type::RIGHT, "RIGHT" },
+                { bn::keypad::key_type::LEFT, "LEFT" },
+                { bn::keypad::key_type::UP, "UP" },
+                { bn::keypad::key_type::DOWN, "DOWN" },
+                { bn::keypad::key_type::R, "R" },
+                { bn::keypad::key_type::L, "L" }
+            };
+        #endif
+    }
+
+    void update()
+    {
+        ++current_frame;
+
+        if constexpr(replaying)
+        {
+            if(current_frame == data::input_script_frames)
+            {
+                BN_LOG("Input script finished at frame ", current_frame);
+            }
+
+            // Skip the events of the previous frames
+            while(next_event < script_events && data::input_script[next_event].frame < current_frame)
+            {
+                ++next_event;
+            }
+        }
+        else
+        {
+            #ifdef INPUT_RECORD
+                for(const key_name& key_name : key_names)
+                {
+                    if(bn::keypad::pressed(key_name.key))
+                    {
+                        BN_LOG("{ ", current_frame, ", bn::keypad::key_type::", key_name.name, " },");
+                    }
+                }
+            #endif
+        }
+    }
+
+    int frame()
+    {
+        return current_frame;
+    }
+
+    bool pressed(bn::keypad::key_type key)
+    {
+        if constexpr(replaying)
+        {
+            for(int index = next_event; index < script_events; ++index)
+            {
+                const event& script_event = data::input_script[index];
+
+                if(script_event.frame != current_frame)
+                {
+                    return false;
+                }
+
+                if(script_event.key == key)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+        else
+        {
+            return bn::keypad::pressed(key);
+        }
+    }
+}
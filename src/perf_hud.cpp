@@ -0,0 +1,191 @@
+//--------------------------------------------------------------------------------
+// perf_hud.cpp
+//--------------------------------------------------------------------------------
+// On-screen performance overlay
+//--------------------------------------------------------------------------------
+
+#include "perf_hud.h"
+
+#include "bn_tile.h"
+#include "bn_array.h"
+#include "bn_algorithm.h"
+#include "bn_display.h"
+#include "bn_sprite_item.h"
+
+namespace
+{
+    // Glyphs of the font: the ten digits, a blank space and the field labels
+    constexpr int blank_glyph = 10;
+    constexpr int c_glyph = 11;
+    constexpr int p_glyph = 12;
+    constexpr int v_glyph = 13;
+    constexpr int b_glyph = 14;
+    constexpr int glyphs_count = 15;
+
+    // 3x5 pixels of each glyph, one row per 3 bits (the highest bit is the leftmost pixel)
+    constexpr uint8_t glyph_rows[glyphs_count][5] = {
+        { 7, 5, 5, 5, 7 }, { 2, 6, 2, 2, 7 }, { 7, 1, 7, 4, 7 }, { 7, 1, 7, 1, 7 }, { 5, 5, 7, 1, 1 },
+        { 7, 4, 7, 1, 7 }, { 7, 4, 7, 5, 7 }, { 7, 1, 2, 2, 2 }, { 7, 5, 7, 5, 7 }, { 7, 5, 7, 1, 7 },
+        { 0, 0, 0, 0, 0 }, { 7, 4, 4, 4, 7 }, { 7, 5, 7, 4, 4 }, { 5, 5, 5, 5, 2 }, { 6, 5, 6, 5, 6 }
+    };
+
+    // Glyphs are drawn with color 1 over a box of color 2, so they can be read over any flag
+    constexpr bn::array<bn::tile, glyphs_count> generate_glyph_tiles()
+    {
+        bn::array<bn::tile, glyphs_count> result = {};
+
+        for(int glyph = 0; glyph < glyphs_count; ++glyph)
+        {
+            for(int y = 0; y < 8; ++y)
+            {
+                uint32_t row = 0x22222222;
+
+                if(y >= 1 && y <= 5)
+                {
+                    int bits = glyph_rows[glyph][y - 1];
+
+                    // Pixel x is the nibble x of the row, and the glyph is placed at x = 2, 3, 4
+                    for(int x = 0; x < 3; ++x)
+                    {
+                        if(bits & (4 >> x))
+                        {
+                            row ^= uint32_t(0x3) << (4 * (x + 2));
+                        }
+                    }
+                }
+
+                result[glyph].data[y] = row;
+            }
+        }
+
+        return result;
+    }
+
+    constexpr bn::array<bn::tile, glyphs_count> glyph_tiles = generate_glyph_tiles();
+
+    constexpr bn::color colors[16] = {
+        bn::color(0, 0, 0), bn::color(31, 31, 31), bn::color(2, 2, 4)
+    };
+
+    constexpr bn::sprite_item font_item(
+            bn::sprite_shape_size(bn::sprite_shape::SQUARE, bn::sprite_size::SMALL),
+            bn::sprite_tiles_item(glyph_tiles, bn::bpp_mode::BPP_4),
+            bn::sprite_palette_item(colors, bn::bpp_mode::BPP_4));
+
+    // Label, position (in 8x8 cells from the top left corner) and digits of each field
+    struct field_layout
+    {
+        int label;
+        int column;
+        int row;
+        int digits;
+    };
+
+    constexpr field_layout fields[] = {
+        { c_glyph, 0, 0, 6 },
+        { p_glyph, 8, 0, 6 },
+        { v_glyph, 0, 1, 3 },
+        { b_glyph, 0, 2, 6 }
+    };
+
+    constexpr int fields_count = sizeof(fields) / sizeof(fields[0]);
+    constexpr int current_cycles_field = 0;
+    constexpr int peak_cycles_field = 1;
+    constexpr int scanline_field = 2;
+    constexpr int copied_bytes_field = 3;
+
+    // First digit sprite of the given field: each field is a label sprite followed by its digits
+    constexpr int first_digit_sprite(int field)
+    {
+        int result = 1;
+
+        for(int index = 0; index < field; ++index)
+        {
+            result += fields[index].digits + 1;
+        }
+
+        return result;
+    }
+
+    static_assert(first_digit_sprite(fields_count) - 1 <= perf_hud::max_sprites);
+}
+
+perf_hud perf_hud::create()
+{
+    // Sprite coordinates are relative to the center of the screen
+    constexpr int margin = 4;
+    int left = margin + 4 - bn::display::width() / 2;
+    int top = margin + 4 - bn::display::height() / 2;
+    bn::vector<bn::sprite_ptr, max_sprites> sprites;
+
+    for(const field_layout& field : fields)
+    {
+        for(int cell = 0; cell <= field.digits; ++cell)
+        {
+            int glyph = cell ? blank_glyph : field.label;
+            sprites.push_back(font_item.create_sprite(left + 8 * (field.column + cell), top + 8 * field.row, glyph));
+        }
+    }
+
+    return perf_hud(bn::move(sprites));
+}
+
+void perf_hud::update(int update_cycles, int end_scanline, int copied_bytes)
+{
+    _peak_cycles = bn::max(_peak_cycles, update_cycles);
+
+    if(++_frames < refresh_frames)
+    {
+        return;
+    }
+
+    _frames = 0;
+    _set_number(current_cycles_field, update_cycles);
+    _set_number(peak_cycles_field, _peak_cycles);
+    _set_number(scanline_field, end_scanline);
+    _set_number(copied_bytes_field, copied_bytes);
+}
+
+perf_hud::perf_hud(bn::vector<bn::sprite_ptr, max_sprites>&& sprites) :
+    _sprites(bn::move(sprites))
+{
+    for(int field = 0; field < fields_count; ++field)
+    {
+        int first_sprite = first_digit_sprite(field);
+        _glyphs[first_sprite - 1] = uint8_t(fields[field].label);
+
+        for(int digit = 0; digit < fields[field].digits; ++digit)
+        {
+            _glyphs[first_sprite + digit] = blank_glyph;
+        }
+    }
+}
+
+void perf_hud::_set_number(int field, int value)
+{
+    int digits = fields[field].digits;
+    int first_sprite = first_digit_sprite(field);
+
+    // Values which don't fit are shown with all nines
+    int max_value = 9;
+
+    for(int digit = 1; digit < digits; ++digit)
+    {
+        max_value = max_value * 10 + 9;
+    }
+
+    value = bn::clamp(value, 0, max_value);
+
+    // Only the sprites whose glyph changes get new tiles
+    for(int sprite = first_sprite + digits - 1; sprite >= first_sprite; --sprite)
+    {
+        int glyph = value || sprite == first_sprite + digits - 1 ? value % 10 : blank_glyph;
+        value /= 10;
+
+        if(_glyphs[sprite] != glyph)
+        {
+            _glyphs[sprite] = uint8_t(glyph);
+            _sprites[sprite].set_tiles(font_item.tiles_item(), glyph);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------------
+// phase_variant_bg.bn_iwram.cpp
+//--------------------------------------------------------------------------------
+// Map cells generation, placed in IWRAM and compiled as ARM
+//--------------------------------------------------------------------------------
+
+#include "phase_variant_bg.h"
+
+void phase_variant_bg::_generate_cells()
+{
+    // Every column is written from the highest row it can reach to the lowest one,
+    // so the cells it left in the previous update are always cleared
+    const strip_layout& layout = _layout;
+    int rows = layout.height + 1;
+    int area_rows = rows + 2 * layout.max_tile_offset + 1;
+    int strip_width = layout.strip_width;
+    bn::regular_bg_map_cell* area_ptr = _cells->data() + 32 * (layout.y - layout.max_tile_offset - 1) + layout.x;
+
+    for(int column = 0, strip = 0; column < layout.width; ++strip)
+    {
+        // A displacement is a tile offset and a phase (floor division, since they can be negative)
+        int disp = _displacements[strip];
+        int first_y = (disp >> 3) + layout.max_tile_offset + 1;
+        const int16_t* phase_tiles = _phase_tiles[column];
+        int phase = disp & (phases - 1);
+
+        for(int last_column = column + strip_width; column < last_column; ++column)
+        {
+            bn::regular_bg_map_cell* cells_ptr = area_ptr + column;
+            int tile = phase_tiles[phase];
+            int y = 0;
+
+            for(; y < first_y; ++y)
+            {
+                cells_ptr[32 * y] = 0;
+            }
+
+            for(int last_y = first_y + rows; y < last_y; ++y)
+            {
+                cells_ptr[32 * y] = bn::regular_bg_map_cell(tile);
+                ++tile;
+            }
+
+            for(; y < area_rows; ++y)
+            {
+                cells_ptr[32 * y] = 0;
+            }
+
+            phase_tiles += phases;
+        }
+    }
+}
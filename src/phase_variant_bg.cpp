@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------
+// phase_variant_bg.cpp
+//--------------------------------------------------------------------------------
+// Background whose tile columns are moved up and down only with map cells
+//--------------------------------------------------------------------------------
+
+#include "phase_variant_bg.h"
+
+#include "bn_memory.h"
+#include "bn_bg_palette_ptr.h"
+#include "bn_regular_bg_tiles_ptr.h"
+
+#include "tile_flips.h"
+#include "arm_functions.h"
+
+phase_variant_bg phase_variant_bg::create(const bn::regular_bg_item& item, const strip_layout& layout)
+{
+    BN_ASSERT(layout.x >= 0 && layout.x + layout.width <= 32, "Invalid layout x: ", layout.x, " - ", layout.width);
+    BN_ASSERT(layout.y - layout.max_tile_offset - 1 >= 0 && layout.y + layout.height + layout.max_tile_offset < 32,
+              "Invalid layout y: ", layout.y, " - ", layout.height, " - ", layout.max_tile_offset);
+    BN_ASSERT(layout.strip_width > 0 && layout.width % layout.strip_width == 0,
+              "Invalid strip width: ", layout.strip_width);
+    BN_ASSERT(layout.width <= max_columns, "Too many columns: ", layout.width);
+    BN_ASSERT(fits(layout), "Too many tiles: ", allocated_tiles(layout));
+
+    // Allocate tiles and maps needed for the background (2 * 4bpp tiles for each 8bpp tile)
+    bn::regular_bg_tiles_ptr tiles = bn::regular_bg_tiles_ptr::allocate(
+                2 * allocated_tiles(layout), bn::bpp_mode::BPP_8);
+    bn::bg_palette_ptr palette = item.palette_item().create_palette();
+
+    // The lines above and below each phase are never drawn, so every tile must start blank
+    // (16 words per 8bpp tile)
+    bn::memory::set_words(0, 16 * allocated_tiles(layout), tiles.vram()->data());
+
+    // The map references blank cells in EWRAM: the columns are placed by the constructor
+    bn::unique_ptr<strip_map::cells_type> cells(new strip_map::cells_type());
+    bn::regular_bg_map_ptr map = bn::regular_bg_map_ptr::create(
+                (*cells)[0], bn::size(32, 32), bn::move(tiles), bn::move(palette));
+
+    // Now, create the background
+    bn::regular_bg_ptr bg = bn::regular_bg_ptr::create(0, 0, map);
+    return phase_variant_bg(item, layout, bn::move(cells), bn::move(map), bn::move(bg));
+}
+
+phase_variant_bg::phase_variant_bg(
+        const bn::regular_bg_item& item, const strip_layout& layout, bn::unique_ptr<strip_map::cells_type>&& cells,
+        bn::regular_bg_map_ptr&& map, bn::regular_bg_ptr&& bg) :
+    _item(&item),
+    _layout(layout),
+    _cells(bn::move(cells)),
+    _map(bn::move(map)),
+    _bg(bn::move(bg))
+{
+    for(int column = 0; column < layout.width; ++column)
+    {
+        for(int phase = 0; phase < phases; ++phase)
+        {
+            _phase_tiles[column][phase] = int16_t(_phase_tile(layout, column, phase));
+        }
+    }
+
+    _transfer();
+    _generate_cells();
+    _map.reload_cells_ref();
+}
+
+void phase_variant_bg::_transfer()
+{
+    // Get the necessary data
+    const bn::regular_bg_item& item = *_item;
+    const strip_layout& layout = _layout;
+    const bn::tile* item_tiles_ptr = item.tiles_item().tiles_ref().data();
+    const bn::regular_bg_map_cell* item_map_ptr = item.map_item().cells_ptr();
+    int item_map_width = item.map_item().dimensions().width();
+    BN_ASSERT(item_map_width == 32, "Invalid item map width: ", item_map_width);
+    bool flipped = tile_flips::any(item, layout);
+
+    // Since we're doing 8-bpp tiles, we need the 2* in this place
+    bn::regular_bg_tiles_ptr bg_tiles = _bg.tiles();
+    bn::tile* tiles_ptr = bg_tiles.vram()->data();
+
+    // Draw each phase of each column moved phase lines down inside its tiles
+    // uint64_t is 8 bytes, exactly the size of one tile row
+    for(int column = 0; column < layout.width; ++column)
+    {
+        const bn::regular_bg_map_cell* map_ptr = item_map_ptr + (item_map_width * layout.y + layout.x + column);
+
+        for(int phase = 0; phase < phases; ++phase)
+        {
+            uint64_t* line_ptr = reinterpret_cast<uint64_t*>(tiles_ptr + 2 * _phase_tile(layout, column, phase));
+            arm::copy_vertical_tile_strip_8bpp_fastest(line_ptr + phase, item_tiles_ptr, map_ptr, layout.height,
+                                                       flipped);
+        }
+    }
+
+    // Fix the palette
+    bn::bg_palette_ptr bg_palette = _bg.palette();
+    bg_palette.set_colors(item.palette_item());
+}
@@ -0,0 +1,382 @@
+//--------------------------------------------------------------------------------
+// strip_displacement_bg.cpp
+//--------------------------------------------------------------------------------
+// Background whose vertical strips can be moved up and down independently
+//--------------------------------------------------------------------------------
+
+#include "strip_displacement_bg.h"
+
+#include "bn_span.h"
+#include "bn_memory.h"
+#include "bn_math.h"
+#include "bn_algorithm.h"
+#include "bn_bg_palette_ptr.h"
+#include "bn_regular_bg_tiles_ptr.h"
+
+#include "arm_functions.h"
+
+strip_displacement_bg strip_displacement_bg::_create(
+        const bn::regular_bg_item& item, const strip_layout& layout, const int8_t* displacements, int buffers,
+        const strip_map::cells_type* const* map_cells, bool clear_all_tiles)
+{
+    BN_ASSERT(buffers == 1 || buffers == 2, "Invalid buffers: ", buffers);
+    BN_ASSERT(layout.x >= 0 && layout.x + layout.width <= 32, "Invalid layout x: ", layout.x, " - ", layout.width);
+    BN_ASSERT(layout.y - layout.max_tile_offset >= 1 && layout.y + layout.height + layout.max_tile_offset + 1 <= 32,
+              "Invalid layout y: ", layout.y, " - ", layout.height, " - ", layout.max_tile_offset);
+    BN_ASSERT(buffers == 2 || ! layout.max_tile_offset, "Tile offsets need two buffers");
+    BN_ASSERT(layout.strip_width > 0 && layout.width % layout.strip_width == 0,
+              "Invalid strip width: ", layout.strip_width);
+    BN_ASSERT(layout.strips() <= max_strips, "Too many strips: ", layout.strips());
+    BN_ASSERT(layout.allocated_tiles(buffers) <= 1024, "Too many tiles: ", layout.allocated_tiles(buffers));
+
+    // Allocate tiles and maps needed for the background
+    // The 2 multiplying here is because an 8bpp has double the size as two 4bpp tiles,
+    // but the function accepts only 4bpp tiles, so we need to multiply
+    bn::regular_bg_tiles_ptr tiles = bn::regular_bg_tiles_ptr::allocate(
+                2 * layout.allocated_tiles(buffers), bn::bpp_mode::BPP_8);
+    bn::bg_palette_ptr palette = item.palette_item().create_palette();
+
+    // The first tile is displayed outside the region, and the padding tiles are never copied, so they must
+    // start blank. The rest of the lines are always covered by a strip, either by _transfer() for the displayed
+    // buffer or by the first update for the other one, so only the padding tiles between each pair of columns
+    // and the lines next to them which a displaced strip doesn't reach are cleared (2 words per line).
+    // create_legacy() still clears every tile, to compare both
+    uint64_t* lines_ptr = reinterpret_cast<uint64_t*>(tiles.vram()->data());
+
+    if(clear_all_tiles)
+    {
+        bn::memory::set_words(0, 16 * layout.allocated_tiles(buffers), lines_ptr);
+    }
+    else
+    {
+        bn::memory::set_words(0, 2 * 8, lines_ptr);
+
+        int column_lines = 8 * layout.column_stride();
+        int buffer_lines = 8 * layout.buffer_tiles();
+
+        for(int i = 0; i < buffers; ++i)
+        {
+            uint64_t* buffer_lines_ptr = lines_ptr + 8 + buffer_lines * i;
+
+            for(int x = 0; x <= layout.width; ++x)
+            {
+                int first_line = bn::max(column_lines * x - 8 - strip_layout::max_displacement, 0);
+                int last_line = bn::min(column_lines * x + 8 + strip_layout::max_displacement, buffer_lines);
+                bn::memory::set_words(0, 2 * (last_line - first_line), buffer_lines_ptr + first_line);
+            }
+        }
+    }
+
+    // Create the maps
+    bn::vector<bn::regular_bg_map_ptr, 2> maps;
+
+    for(int i = 0; i < buffers; ++i)
+    {
+        constexpr bn::size map_size(32, 32);
+
+        bn::regular_bg_map_ptr map = bn::regular_bg_map_ptr::allocate(map_size, tiles, palette);
+        bn::span<bn::regular_bg_map_cell> vram = *map.vram();
+
+        if(map_cells)
+        {
+            // Copy the generated map at once
+            bn::memory::copy((*map_cells[i])[0], strip_map::cells_count, vram[0]);
+        }
+        else
+        {
+            // First fill the map blank, and then fill in the region with the proper values
+            bn::fill(vram.begin(), vram.end(), bn::regular_bg_map_cell());
+
+            for(int x = 0; x < layout.width; x++)
+            {
+                for(int y = 0; y < layout.height + 2; y++)
+                {
+                    int tile_x = layout.x + x;
+                    int tile_y = layout.y + y - 1;
+                    vram[32 * tile_y + tile_x] = strip_map::cell(layout, i, tile_x, tile_y);
+                }
+            }
+        }
+
+        maps.push_back(bn::move(map));
+    }
+
+    // Now, create the background
+    bn::regular_bg_ptr bg = bn::regular_bg_ptr::create(0, 0, maps[0]);
+    return strip_displacement_bg(item, layout, bn::move(bg), bn::move(maps), displacements);
+}
+
+#ifdef BENCHMARK
+    strip_displacement_bg strip_displacement_bg::create_legacy(const bn::regular_bg_item& item,
+                                                               const strip_layout& layout)
+    {
+        strip_displacement_bg result = _create(item, layout, nullptr, 2, nullptr, true);
+        int back_buffer = result._displayed_buffer ^ 1;
+
+        for(int strip = 0, strips = layout.strips(); strip < strips; ++strip)
+        {
+            result._draw_strip(item, result._item_flipped, back_buffer, strip, 0);
+        }
+
+        result._back_buffer_outdated = false;
+        return result;
+    }
+#endif
+
+void strip_displacement_bg::reveal_item(const bn::regular_bg_item& item, int strips_per_update)
+{
+    BN_ASSERT(buffers() == 2, "Reveal needs two buffers");
+    BN_ASSERT(strips_per_update > 0, "Invalid strips per update: ", strips_per_update);
+
+    _revealed_item = &item;
+    _revealed_item_flipped = tile_flips::any(item, _layout);
+    _revealed_strips = 0;
+    _reveal_speed = strips_per_update;
+
+    bn::bg_palette_ptr bg_palette = _bg.palette();
+    bg_palette.set_colors(item.palette_item());
+}
+
+void strip_displacement_bg::replay(const int8_t* deltas)
+{
+    BN_ASSERT(buffers() == 2, "Replay needs two buffers");
+
+    bool sparse = _sparse_enabled && ! _back_buffer_outdated && ! _revealed_item;
+
+    if(_revealed_item)
+    {
+        _reveal_strips();
+    }
+
+    int src = _displayed_buffer;
+    const int8_t* src_displacements = _displacements[src];
+    int8_t* dst_displacements = _displacements[src ^ 1];
+    const bn::tile* src_tiles_ptr = _buffer_tiles(src);
+    bn::tile* dst_tiles_ptr = _buffer_tiles(src ^ 1);
+    int strips = _layout.strips();
+    int max_disp = _layout.max_total_displacement();
+    _updated_strips = strips;
+    copy_list copies;
+
+    for(int strip = 0; strip < strips; ++strip)
+    {
+        int disp = src_displacements[strip];
+        int old_dst_disp = dst_displacements[strip];
+        int d_disp = deltas[strip];
+        BN_ASSERT(bn::abs(d_disp) <= strip_layout::max_delta, "Invalid delta: ", strip, " - ", d_disp);
+        BN_ASSERT(bn::abs(disp + d_disp) <= max_disp, "Invalid displacement: ", strip, " - ", disp + d_disp);
+        dst_displacements[strip] = int8_t(disp + d_disp);
+        _push_strip(src_tiles_ptr, dst_tiles_ptr, strip, disp, d_disp, old_dst_disp, sparse, copies);
+    }
+
+    _present(copies);
+}
+
+strip_displacement_bg::strip_displacement_bg(
+        const bn::regular_bg_item& item, const strip_layout& layout, bn::regular_bg_ptr&& bg,
+        bn::vector<bn::regular_bg_map_ptr, 2>&& maps, const int8_t* displacements) :
+    _item(&item),
+    _layout(layout),
+    _bg(bn::move(bg)),
+    _maps(bn::move(maps))
+{
+    if(displacements)
+    {
+        for(int strip = 0, strips = layout.strips(); strip < strips; ++strip)
+        {
+            _displacements[0][strip] = displacements[strip];
+            _displacements[1][strip] = displacements[strip];
+        }
+    }
+
+    // The generated maps have every strip without tile offset
+    if(layout.max_tile_offset)
+    {
+        for(int buffer = 0; buffer < buffers(); ++buffer)
+        {
+            for(int strip = 0, strips = layout.strips(); strip < strips; ++strip)
+            {
+                if(int tile_offset = layout.tile_offset(_displacements[buffer][strip]))
+                {
+                    _set_tile_offset(buffer, strip, 0, tile_offset);
+                }
+            }
+        }
+    }
+
+    _item_flipped = tile_flips::any(item, layout);
+    _transfer();
+}
+
+bn::tile* strip_displacement_bg::_buffer_tiles(int buffer) const
+{
+    // Same thing here, since we're doing 8-bpp tiles, we need the 2* in this place
+    bn::regular_bg_tiles_ptr bg_tiles = _bg.tiles();
+    return bg_tiles.vram()->data() + 2 * (_layout.buffer_tiles() * buffer + 1);
+}
+
+void strip_displacement_bg::_present(copy_list& copies)
+{
+    // Execute the copies all at once
+    _execute(copies);
+    _copied_bytes = 4 * copies.words();
+
+    // And swap the buffers
+    _back_buffer_outdated = false;
+
+    if(buffers() == 2)
+    {
+        int dst = _displayed_buffer ^ 1;
+        _displayed_buffer = dst;
+        _bg.set_map(_maps[dst]);
+    }
+}
+
+void strip_displacement_bg::_find_line_changes()
+{
+    const strip_layout& layout = _layout;
+    int column_lines = 8 * layout.column_stride();
+    int strip_lines = column_lines * layout.strip_width - 16;
+    const uint64_t* buffer_lines_ptr = reinterpret_cast<const uint64_t*>(_buffer_tiles(_displayed_buffer));
+    const int8_t* displacements = _displacements[_displayed_buffer];
+
+    for(int strip = 0, strips = layout.strips(); strip < strips; ++strip)
+    {
+        const uint64_t* lines_ptr = buffer_lines_ptr + column_lines * layout.strip_width * strip + 8 +
+                layout.line_offset(displacements[strip]);
+        int16_t* line_changes = _line_changes[strip];
+        int count = 0;
+
+        // Stop counting after max_line_changes, since the strip is going to be copied whole anyway
+        for(int line = 1; line < strip_lines && count <= max_line_changes; ++line)
+        {
+            if(lines_ptr[line] != lines_ptr[line - 1])
+            {
+                if(count < max_line_changes)
+                {
+                    line_changes[count] = int16_t(line);
+                }
+
+                ++count;
+            }
+        }
+
+        _line_changes_count[strip] = int8_t(count);
+    }
+}
+
+void strip_displacement_bg::_set_tile_offset(int buffer, int strip, int old_tile_offset, int new_tile_offset)
+{
+    // Rewrite the rows covered by the column at any of both offsets, so the ones it leaves are blank
+    const strip_layout& layout = _layout;
+    bn::span<bn::regular_bg_map_cell> vram = *_maps[buffer].vram();
+    int first_y = layout.y - 1 + bn::min(old_tile_offset, new_tile_offset);
+    int last_y = layout.y + layout.height + 1 + bn::max(old_tile_offset, new_tile_offset);
+
+    for(int x = layout.x + strip * layout.strip_width, last_x = x + layout.strip_width; x < last_x; ++x)
+    {
+        for(int y = first_y; y < last_y; ++y)
+        {
+            vram[32 * y + x] = strip_map::cell(layout, buffer, x, y, new_tile_offset);
+        }
+    }
+}
+
+void strip_displacement_bg::_draw_strip(const bn::regular_bg_item& item, bool flipped, int buffer, int strip,
+                                        int disp) const
+{
+    const strip_layout& layout = _layout;
+    const bn::tile* item_tiles_ptr = item.tiles_item().tiles_ref().data();
+    const bn::regular_bg_map_cell* item_map_ptr = item.map_item().cells_ptr();
+    BN_ASSERT(item.map_item().dimensions().width() == 32, "Invalid item map width: ",
+              item.map_item().dimensions().width());
+
+    int column_lines = 8 * layout.column_stride();
+    uint64_t* buffer_lines_ptr = reinterpret_cast<uint64_t*>(_buffer_tiles(buffer));
+    disp = layout.line_offset(disp);
+
+    for(int x = strip * layout.strip_width, last_x = x + layout.strip_width; x < last_x; ++x)
+    {
+        // The strip starts 8 lines down because of the padding tile
+        uint64_t* line_ptr = buffer_lines_ptr + column_lines * x + 8 + disp;
+        const bn::regular_bg_map_cell* map_ptr = item_map_ptr + (32 * layout.y + layout.x + x);
+        arm::copy_vertical_tile_strip_8bpp_fastest(line_ptr, item_tiles_ptr, map_ptr, layout.height, flipped);
+    }
+}
+
+void strip_displacement_bg::_redraw_strip(int strip, int disp, int d_disp, copy_list& copies)
+{
+    // A strip which doesn't move is already drawn
+    if(! d_disp)
+    {
+        return;
+    }
+
+    const strip_layout& layout = _layout;
+    int new_disp = disp + d_disp;
+    _draw_strip(*_item, _item_flipped, _displayed_buffer, strip, new_disp);
+
+    // Clear the lines left behind, which are in the padding
+    int column_lines = 8 * layout.column_stride();
+    int flag_lines = 8 * layout.height;
+    uint64_t* buffer_lines_ptr = reinterpret_cast<uint64_t*>(_buffer_tiles(_displayed_buffer));
+
+    for(int x = strip * layout.strip_width, last_x = x + layout.strip_width; x < last_x; ++x)
+    {
+        if(copies.full())
+        {
+            _execute(copies);
+        }
+
+        uint64_t* line_ptr = buffer_lines_ptr + column_lines * x + 8;
+        uint64_t* cleared_line_ptr = d_disp > 0 ? line_ptr + disp : line_ptr + new_disp + flag_lines;
+        copies.push_back(blank_tile_8bpp, cleared_line_ptr, 2 * bn::abs(d_disp));
+    }
+}
+
+void strip_displacement_bg::_reveal_strips()
+{
+    int first_strip = _revealed_strips;
+    int last_strip = bn::min(first_strip + _reveal_speed, _layout.strips());
+    const int8_t* displacements = _displacements[_displayed_buffer];
+
+    // Each strip is drawn over itself, so its padding stays blank
+    for(int strip = first_strip; strip < last_strip; ++strip)
+    {
+        _draw_strip(*_revealed_item, _revealed_item_flipped, _displayed_buffer, strip, displacements[strip]);
+    }
+
+    _revealed_strips = last_strip;
+
+    if(last_strip == _layout.strips())
+    {
+        _item = _revealed_item;
+        _item_flipped = _revealed_item_flipped;
+        _revealed_item = nullptr;
+        _find_line_changes();
+    }
+}
+
+void strip_displacement_bg::_transfer()
+{
+    // Each strip is drawn by the fastest routine for the item, which resolves the map and the flipped tiles
+    const bn::regular_bg_item& item = *_item;
+    const int8_t* displacements = _displacements[_displayed_buffer];
+
+    for(int strip = 0, strips = _layout.strips(); strip < strips; ++strip)
+    {
+        _draw_strip(item, _item_flipped, _displayed_buffer, strip, displacements[strip]);
+    }
+
+    // The other buffer still has the previous item
+    _back_buffer_outdated = buffers() == 2;
+
+    if(_back_buffer_outdated)
+    {
+        _find_line_changes();
+    }
+
+    // Fix the palette
+    bn::bg_palette_ptr bg_palette = _bg.palette();
+    bg_palette.set_colors(item.palette_item());
+}
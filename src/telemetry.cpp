@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------
+// telemetry.cpp
+//--------------------------------------------------------------------------------
+// Per-frame stats of the flag effect, logged in batches
+//--------------------------------------------------------------------------------
+
+#include "telemetry.h"
+
+#include "bn_log.h"
+
+namespace telemetry
+{
+    namespace
+    {
+        BN_DATA_EWRAM_BSS record records[capacity];
+        record last_record;
+        int first_record = 0;
+        int records_count = 0;
+        int dropped_records = 0;
+    }
+
+    void push(const record& value)
+    {
+        if constexpr(enabled)
+        {
+            last_record = value;
+
+            if(records_count == capacity)
+            {
+                first_record = (first_record + 1) & (capacity - 1);
+                --records_count;
+                ++dropped_records;
+            }
+
+            records[(first_record + records_count) & (capacity - 1)] = value;
+            ++records_count;
+        }
+    }
+
+    const record& last()
+    {
+        return last_record;
+    }
+
+    int pending()
+    {
+        return records_count;
+    }
+
+    void flush()
+    {
+        if constexpr(enabled)
+        {
+            // Columns: frame, simulation cycles, strips cycles, copied bytes, columns updated, quality level, crossfade
+            BN_LOG("telemetry: ", records_count, " records, ", dropped_records, " dropped");
+
+            for(int index = 0; index < records_count; ++index)
+            {
+                const record& value = records[(first_record + index) & (capacity - 1)];
+                BN_LOG(value.frame, ' ', value.simulation_cycles, ' ', value.strips_cycles, ' ', value.copied_bytes,
+                       ' ', value.columns_updated, ' ', int(value.quality_level), ' ', int(value.crossfading));
+            }
+
+            first_record = 0;
+            records_count = 0;
+            dropped_records = 0;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+//--------------------------------------------------------------------------------
+// tile_flips.cpp
+//--------------------------------------------------------------------------------
+// Detection of flipped tiles in background items
+//--------------------------------------------------------------------------------
+
+#include "tile_flips.h"
+
+#include "bn_regular_bg_map_cell_info.h"
+
+bool tile_flips::any(const bn::regular_bg_item& item, const strip_layout& layout)
+{
+    const bn::regular_bg_map_cell* map_ptr = item.map_item().cells_ptr();
+    int map_width = item.map_item().dimensions().width();
+
+    for(int y = layout.y, last_y = y + layout.height; y < last_y; ++y)
+    {
+        for(int x = layout.x, last_x = x + layout.width; x < last_x; ++x)
+        {
+            bn::regular_bg_map_cell_info cell_info(map_ptr[map_width * y + x]);
+
+            if(cell_info.horizontal_flip() || cell_info.vertical_flip())
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
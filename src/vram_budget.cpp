@@ -0,0 +1,26 @@
+//--------------------------------------------------------------------------------
+// vram_budget.cpp
+//--------------------------------------------------------------------------------
+// Background VRAM and palette accounting
+//--------------------------------------------------------------------------------
+
+#include "vram_budget.h"
+
+#include "bn_log.h"
+#include "bn_bg_maps.h"
+#include "bn_bg_tiles.h"
+#include "bn_bg_palettes.h"
+
+vram_budget::usage vram_budget::current()
+{
+    // butano counts 4bpp tiles (32 bytes) and map cells (2 bytes)
+    return { 32 * bn::bg_tiles::used_tiles_count(), 2 * bn::bg_maps::used_cells_count(),
+             bn::bg_palettes::used_colors_count() };
+}
+
+void vram_budget::log(const char* name, const usage& usage)
+{
+    BN_LOG(name, ": ", usage.tiles_bytes, " tiles bytes, ", usage.maps_bytes, " maps bytes (",
+           usage.free_vram_bytes(), " of ", bg_vram_bytes, " free), ", usage.palette_colors, " colors (",
+           usage.free_palette_colors(), " free)");
+}
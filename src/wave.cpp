@@ -0,0 +1,37 @@
+//--------------------------------------------------------------------------------
+// wave.cpp
+//--------------------------------------------------------------------------------
+// Precomputed sine wave displacements
+//--------------------------------------------------------------------------------
+
+#include "wave.h"
+
+#include "bn_math.h"
+
+namespace wave
+{
+    int8_t displacements[period];
+    BN_DATA_EWRAM_BSS int8_t schedule[period][data::flag_width_tiles];
+
+    void init()
+    {
+        for(int phase = 0; phase < period; ++phase)
+        {
+            // This is just to make it beautiful
+            int a = data::wave_horizontal_multiplier * phase;
+            displacements[phase] = int8_t((data::wave_vertical_amplitude * bn::lut_sin(a & 2047)).round_integer());
+        }
+    }
+}
+
+void wave::init_schedule()
+{
+    for(int frame = 0; frame < period; ++frame)
+    {
+        for(int column = 0; column < data::flag_width_tiles; ++column)
+        {
+            int x = 8 * column;
+            schedule[frame][column] = int8_t(displacement(x, frame + 1) - displacement(x, frame));
+        }
+    }
+}
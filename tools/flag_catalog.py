@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+"""
+Generates include/flag_catalog.h, which lists every regular background item of the graphics folder.
+
+Run from the project folder (the Makefile runs it as EXTTOOL before building).
+The header is ignored by git, so it always matches the graphics folder.
+It is only rewritten when its contents change, so it doesn't trigger rebuilds.
+"""
+
+import argparse
+import json
+import os
+
+
+def find_items(graphics_folder):
+    items = []
+
+    for file_name in sorted(os.listdir(graphics_folder)):
+        name, extension = os.path.splitext(file_name)
+
+        if extension == '.json':
+            with open(os.path.join(graphics_folder, file_name)) as json_file:
+                info = json.load(json_file)
+
+            if info.get('type') == 'regular_bg':
+                items.append(name)
+
+    return items
+
+
+def generate(items):
+    lines = [
+        '//--------------------------------------------------------------------------------',
+        '// flag_catalog.h',
+        '//--------------------------------------------------------------------------------',
+        '// Every flag of the graphics folder (generated by tools/flag_catalog.py, don\'t edit it)',
+        '//--------------------------------------------------------------------------------',
+        '',
+        '#ifndef FLAG_CATALOG_H',
+        '#define FLAG_CATALOG_H',
+        '',
+    ]
+
+    for item in items:
+        lines.append('#include "bn_regular_bg_items_' + item + '.h"')
+
+    lines += [
+        '',
+        'namespace flag_catalog',
+        '{',
+        '    constexpr int count = ' + str(len(items)) + ';',
+        '',
+        '    constexpr const bn::regular_bg_item* items[count] = {',
+    ]
+
+    for index, item in enumerate(items):
+        lines.append('        &bn::regular_bg_items::' + item + (',' if index < len(items) - 1 else ''))
+
+    lines += [
+        '    };',
+        '',
+        '    constexpr const char* names[count] = {',
+    ]
+
+    for index, item in enumerate(items):
+        lines.append('        "' + item + '"' + (',' if index < len(items) - 1 else ''))
+
+    lines += [
+        '    };',
+        '}',
+        '',
+        '#endif',
+        '',
+    ]
+
+    return '\n'.join(lines)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Flag catalog generator.')
+    parser.add_argument('--graphics', default='graphics', help='graphics folder')
+    parser.add_argument('--output', default='include/flag_catalog.h', help='generated header')
+    args = parser.parse_args()
+
+    items = find_items(args.graphics)
+
+    if not items:
+        raise ValueError('No regular_bg items found in ' + args.graphics)
+
+    contents = generate(items)
+
+    try:
+        with open(args.output) as output_file:
+            old_contents = output_file.read()
+    except IOError:
+        old_contents = None
+
+    if contents != old_contents:
+        with open(args.output, 'w') as output_file:
+            output_file.write(contents)